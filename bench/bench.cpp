@@ -0,0 +1,280 @@
+/**
+ * MIT License
+ * 
+ * Copyright (c) Patrick Dinklage
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#include <benchmark/benchmark.h>
+
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <random>
+#include <string>
+
+#include "bwt.hpp"
+#include "delta.hpp"
+#include "entropy.hpp"
+#include "load.hpp"
+#include "lz77.hpp"
+#include "lz78.hpp"
+#include "plcp.hpp"
+#include "sa.hpp"
+
+using namespace repetitiveness;
+
+// the synthetic corpora, each generated for a given length
+// the mutated repeats consist of copies of a random block over a DNA-like alphabet, each character of which is replaced
+// by a random character with the given probability
+// the zero runs consist of random characters interrupted by runs of zero bytes, which are regular characters
+struct Corpus {
+    char const* name;
+    enum { RANDOM, FIBONACCI, THUE_MORSE, REPEATS, ZERO_RUNS } kind;
+    size_t sigma;
+    double mutation_rate;
+};
+
+constexpr Corpus CORPORA[] = {
+    { "random-4",        Corpus::RANDOM,     4,   0 },
+    { "random-255",      Corpus::RANDOM,     255, 0 },
+    { "fibonacci",       Corpus::FIBONACCI,  2,   0 },
+    { "thue-morse",      Corpus::THUE_MORSE, 2,   0 },
+    { "repeats-1%",      Corpus::REPEATS,    4,   0.01 },
+    { "repeats-0.1%",    Corpus::REPEATS,    4,   0.001 },
+    { "repeats-0.01%",   Corpus::REPEATS,    4,   0.0001 },
+    { "zero-runs",       Corpus::ZERO_RUNS,  4,   0.01 },
+};
+
+constexpr size_t REPEAT_BLOCK_SIZE = 1 << 16;
+
+// generates the given corpus of length n, followed by the sentinel
+std::vector<uint8_t> generate(Corpus const& corpus, size_t const n) {
+    std::vector<uint8_t> text(n + 1, 0);
+    std::mt19937_64 gen(n);
+    std::uniform_int_distribution<size_t> random_char(0, corpus.sigma - 1);
+
+    switch(corpus.kind) {
+        case Corpus::RANDOM:
+            for(size_t i = 0; i < n; i++) text[i] = 1 + random_char(gen);
+            break;
+
+        case Corpus::FIBONACCI: {
+            // the Fibonacci word is the fixed point of a -> ab, b -> a, its characters are determined via the golden ratio
+            double const phi = (1 + std::sqrt(5.0)) / 2;
+            for(size_t i = 0; i < n; i++) {
+                text[i] = 'a' + (size_t(std::floor((i + 2) / phi)) - size_t(std::floor((i + 1) / phi)) == 1 ? 0 : 1);
+            }
+            break;
+        }
+
+        case Corpus::THUE_MORSE:
+            for(size_t i = 0; i < n; i++) text[i] = 'a' + (__builtin_popcountll(i) & 1);
+            break;
+
+        case Corpus::REPEATS: {
+            std::bernoulli_distribution mutate(corpus.mutation_rate);
+            for(size_t i = 0; i < std::min(n, REPEAT_BLOCK_SIZE); i++) text[i] = "ACGT"[random_char(gen)];
+            for(size_t i = REPEAT_BLOCK_SIZE; i < n; i++) {
+                text[i] = mutate(gen) ? "ACGT"[random_char(gen)] : text[i - REPEAT_BLOCK_SIZE];
+            }
+            break;
+        }
+
+        case Corpus::ZERO_RUNS: {
+            // nb: the text ends with zero bytes, so that the shortest suffixes consist of zero bytes followed by the sentinel
+            std::bernoulli_distribution start_run(corpus.mutation_rate);
+            std::uniform_int_distribution<size_t> run_length(1, 16);
+            for(size_t i = 0; i < n;) {
+                if(start_run(gen)) {
+                    for(size_t len = run_length(gen); len > 0 && i < n; len--) text[i++] = 0;
+                } else {
+                    text[i++] = 1 + random_char(gen);
+                }
+            }
+            for(size_t i = n - std::min(n, size_t(16)); i < n; i++) text[i] = 0;
+            break;
+        }
+    }
+    return text;
+}
+
+// a generated corpus along with the data structures that kernels may require, which are constructed on demand
+struct Input {
+    std::vector<uint8_t> text;
+    std::vector<uint32_t> sa;
+    std::vector<uint32_t> plcp;
+    std::vector<uint32_t> lcp; // in SA order
+
+    size_t n() const { return text.size(); }
+    uint8_t const* data() const { return text.data(); }
+};
+
+enum Requirement : unsigned {
+    NEED_SA   = 1 << 0,
+    NEED_PLCP = 1 << 1,
+    NEED_LCP  = 1 << 2,
+};
+
+// retrieves the corpus of the benchmark's arguments, which is generated only once
+Input const& input(benchmark::State& state, unsigned const requirements = 0) {
+    static std::map<std::pair<size_t, size_t>, Input> inputs;
+
+    auto const& corpus = CORPORA[state.range(0)];
+    size_t const n = state.range(1);
+    state.SetLabel(corpus.name);
+
+    auto& in = inputs[{ state.range(0), n }];
+    if(in.text.empty()) in.text = generate(corpus, n);
+    if((requirements & (NEED_SA | NEED_PLCP | NEED_LCP)) && in.sa.empty()) {
+        construct_sa_in_memory(in.data(), in.n(), SABackend::DIVSUFSORT, in.sa);
+    }
+    if((requirements & (NEED_PLCP | NEED_LCP)) && in.plcp.empty()) {
+        construct_plcp_fused(in.data(), in.sa, in.plcp, nullptr, nullptr);
+    }
+    if((requirements & NEED_LCP) && in.lcp.empty()) {
+        in.lcp.resize(in.n());
+        for(size_t i = 0; i < in.n(); i++) in.lcp[i] = in.plcp[in.sa[i]];
+    }
+    return in;
+}
+
+// reports the throughput in terms of input bytes
+void set_throughput(benchmark::State& state, size_t const n) {
+    state.SetBytesProcessed(int64_t(state.iterations()) * n);
+}
+
+void BM_load(benchmark::State& state) {
+    auto const& in = input(state);
+
+    auto const path = std::filesystem::temp_directory_path() / "repetitiveness_bench.txt";
+    std::ofstream(path, std::ios::binary).write((char const*)in.data(), in.n() - 1);
+
+    std::vector<uint8_t> text;
+    for(auto _ : state) {
+        auto const error = load_text(path.string(), SIZE_MAX, text);
+        benchmark::DoNotOptimize(error);
+    }
+    std::filesystem::remove(path);
+    set_throughput(state, in.n());
+}
+
+void BM_h0(benchmark::State& state) {
+    auto const& in = input(state);
+    for(auto _ : state) benchmark::DoNotOptimize(alphabet_entropy(in.data(), in.n() - 1));
+    set_throughput(state, in.n());
+}
+
+template<typename Trie>
+void BM_z78(benchmark::State& state) {
+    auto const& in = input(state);
+    for(auto _ : state) {
+        size_t trie_memory;
+        benchmark::DoNotOptimize(lz78<Trie>(in.data(), in.n() - 1, trie_memory));
+    }
+    set_throughput(state, in.n());
+}
+
+// the SA constructed by the backend is checked against divsufsort's
+template<SABackend backend>
+void BM_sa(benchmark::State& state) {
+    auto const& in = input(state, NEED_SA);
+    std::vector<uint32_t> sa;
+    for(auto _ : state) {
+        construct_sa_in_memory(in.data(), in.n(), backend, sa);
+        benchmark::DoNotOptimize(sa.data());
+    }
+    if(sa != in.sa) state.SkipWithError("the SA differs from divsufsort's");
+    set_throughput(state, in.n());
+}
+
+void BM_plcp_fused(benchmark::State& state) {
+    auto const& in = input(state, NEED_SA);
+    std::vector<uint32_t> plcp;
+    LCPHistogram hist;
+    for(auto _ : state) {
+        size_t r;
+        hist.clear();
+        construct_plcp_fused(in.data(), in.sa, plcp, &r, &hist);
+        benchmark::DoNotOptimize(r);
+    }
+    set_throughput(state, in.n());
+}
+
+void BM_r(benchmark::State& state) {
+    auto const& in = input(state, NEED_SA);
+    for(auto _ : state) {
+        size_t sentinel_pos;
+        auto const bwt = construct_bwt(in.data(), in.sa, sentinel_pos);
+        benchmark::DoNotOptimize(bwt_runs(bwt.data(), in.n(), sentinel_pos));
+    }
+    set_throughput(state, in.n());
+}
+
+void BM_z77_lcp(benchmark::State& state) {
+    auto const& in = input(state, NEED_LCP);
+    for(auto _ : state) benchmark::DoNotOptimize(lz77_lcp<uint32_t>(in.sa, in.lcp, { in.n() - 1 }));
+    set_throughput(state, in.n());
+}
+
+void BM_z77_psv(benchmark::State& state) {
+    auto const& in = input(state, NEED_SA);
+    for(auto _ : state) benchmark::DoNotOptimize(lz77_psv<uint32_t>(in.data(), in.sa, { in.n() - 1 }));
+    set_throughput(state, in.n());
+}
+
+void BM_delta(benchmark::State& state) {
+    auto const& in = input(state, NEED_LCP);
+    for(auto _ : state) benchmark::DoNotOptimize(substring_complexity(in.lcp, in.n()));
+    set_throughput(state, in.n());
+}
+
+void BM_hk(benchmark::State& state) {
+    auto const& in = input(state, NEED_LCP);
+    std::vector<size_t> const ks = { 1, 2, 3, 4 };
+    for(auto _ : state) benchmark::DoNotOptimize(higher_order_entropy(in.data(), in.sa, in.lcp, ks));
+    set_throughput(state, in.n());
+}
+
+// runs a benchmark for every corpus and input length
+void corpora(benchmark::internal::Benchmark* b) {
+    for(size_t c = 0; c < std::size(CORPORA); c++) {
+        for(size_t const n : { size_t(1) << 20, size_t(1) << 24 }) b->Args({ int64_t(c), int64_t(n) });
+    }
+    b->ArgNames({ "corpus", "n" })->Unit(benchmark::kMillisecond);
+}
+
+BENCHMARK(BM_load)->Apply(corpora);
+BENCHMARK(BM_h0)->Apply(corpora);
+BENCHMARK(BM_z78<ListTrie>)->Apply(corpora);
+BENCHMARK(BM_z78<HashTrie>)->Apply(corpora);
+BENCHMARK(BM_z78<HybridTrie>)->Apply(corpora);
+BENCHMARK(BM_sa<SABackend::DIVSUFSORT>)->Apply(corpora);
+BENCHMARK(BM_sa<SABackend::PARALLEL>)->Apply(corpora)->UseRealTime();
+BENCHMARK(BM_plcp_fused)->Apply(corpora);
+BENCHMARK(BM_r)->Apply(corpora);
+BENCHMARK(BM_z77_lcp)->Apply(corpora);
+BENCHMARK(BM_z77_psv)->Apply(corpora);
+BENCHMARK(BM_delta)->Apply(corpora);
+BENCHMARK(BM_hk)->Apply(corpora);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,142 @@
+/**
+ * MIT License
+ * 
+ * Copyright (c) Patrick Dinklage
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include "progress.hpp"
+
+namespace repetitiveness {
+
+// computes the BWT block by block and passes each block to the given function, along with the corresponding SA values
+// the BWT character at the sentinel's position is zero, and that position is returned
+// nb: the SA is accessed sequentially, so it may also be streamed from disk, but the text is accessed randomly, so the
+//     characters for upcoming SA positions are prefetched
+template<typename SA, typename BlockFunc>
+size_t bwt_blocks(uint8_t const* text, SA& sa, BlockFunc&& f) {
+    static constexpr size_t BLOCK_SIZE = 4096;
+    static constexpr size_t PREFETCH_DISTANCE = 32;
+
+    size_t const n = sa.size();
+    size_t sentinel_pos = 0;
+
+    size_t sa_block[BLOCK_SIZE];
+    size_t pos[BLOCK_SIZE];
+    uint8_t block[BLOCK_SIZE];
+    for(size_t b = 0; b < n; b += BLOCK_SIZE) {
+        if(b % PROGRESS_INTERVAL == 0) report_progress(b, n);
+        auto const m = std::min(BLOCK_SIZE, n - b);
+        for(size_t k = 0; k < m; k++) {
+            size_t const j = sa[b + k];
+            if(j == 0) sentinel_pos = b + k;
+            sa_block[k] = j;
+            pos[k] = j > 0 ? j - 1 : n - 1;
+        }
+        for(size_t k = 0; k < std::min(PREFETCH_DISTANCE, m); k++) __builtin_prefetch(text + pos[k]);
+        for(size_t k = 0; k < m; k++) {
+            if(k + PREFETCH_DISTANCE < m) __builtin_prefetch(text + pos[k + PREFETCH_DISTANCE]);
+            block[k] = text[pos[k]];
+        }
+        f(block, sa_block, m);
+    }
+    return sentinel_pos;
+}
+
+// constructs the BWT in RAM and reports the position of the sentinel
+template<typename SA>
+std::vector<uint8_t> construct_bwt(uint8_t const* text, SA& sa, size_t& sentinel_pos) {
+    std::vector<uint8_t> bwt(sa.size());
+    auto* bwt_data = bwt.data();
+    size_t i = 0;
+    sentinel_pos = bwt_blocks(text, sa, [&](uint8_t const* block, size_t const*, size_t const m){
+        std::memcpy(bwt_data + i, block, m);
+        i += m;
+    });
+    return bwt;
+}
+
+// counts the positions at which a character differs from its predecessor (the first character's is given)
+// compares eight pairs of adjacent characters at once
+inline size_t count_changes(uint8_t const* s, size_t const n, uint8_t const prev) {
+    static constexpr uint64_t LO7 = 0x7F7F7F7F7F7F7F7FULL;
+    static constexpr uint64_t HI = 0x8080808080808080ULL;
+
+    if(n == 0) return 0;
+
+    size_t changes = (s[0] != prev);
+    size_t i = 0;
+    for(; i + 9 <= n; i += 8) {
+        uint64_t a, b;
+        std::memcpy(&a, s + i, sizeof(a));
+        std::memcpy(&b, s + i + 1, sizeof(b));
+
+        // set the highest bit of every byte that differs, then count them
+        auto const x = a ^ b;
+        changes += __builtin_popcountll((((x & LO7) + LO7) | x) & HI);
+    }
+    for(; i + 1 < n; i++) changes += (s[i] != s[i + 1]);
+    return changes;
+}
+
+// turns the changes counted in the BWT into its runs, not counting the sentinel's
+// the sentinel ends a run, but the change following it is not counted
+// count_changes cannot tell the sentinel from zero bytes, so the changes adjacent to it are corrected given the BWT
+// characters preceding and following it
+inline size_t sentinel_runs(size_t changes, size_t const n, size_t const sentinel_pos, uint8_t const before, uint8_t const after) {
+    if(sentinel_pos > 0 && before == 0) ++changes;
+    if(sentinel_pos + 1 < n && after != 0) --changes;
+    return changes;
+}
+
+// counts the runs in the BWT, not counting the sentinel's
+inline size_t bwt_runs(uint8_t const* bwt, size_t const n, size_t const sentinel_pos) {
+    auto const before = sentinel_pos > 0 ? bwt[sentinel_pos - 1] : 0;
+    auto const after = sentinel_pos + 1 < n ? bwt[sentinel_pos + 1] : 0;
+    return sentinel_runs(count_changes(bwt + 1, n - 1, bwt[0]), n, sentinel_pos, before, after);
+}
+
+// counts the runs in the BWT like bwt_runs, but without materializing the BWT
+// nb: the BWT characters adjacent to the sentinel are looked up afterwards, which accesses the SA randomly twice
+template<typename SA>
+size_t bwt_runs_streamed(uint8_t const* text, SA& sa) {
+    size_t const n = sa.size();
+
+    size_t changes = 0;
+    bool first = true;
+    uint8_t last = 0;
+    auto const sentinel_pos = bwt_blocks(text, sa, [&](uint8_t const* block, size_t const*, size_t const m){
+        changes += first ? count_changes(block + 1, m - 1, block[0]) : count_changes(block, m, last);
+        first = false;
+        last = block[m - 1];
+    });
+    auto const before = sentinel_pos > 0 ? text[size_t(sa[sentinel_pos - 1]) - 1] : 0;
+    auto const after = sentinel_pos + 1 < n ? text[size_t(sa[sentinel_pos + 1]) - 1] : 0;
+    return sentinel_runs(changes, n, sentinel_pos, before, after);
+}
+
+}
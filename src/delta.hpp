@@ -0,0 +1,109 @@
+/**
+ * MIT License
+ * 
+ * Copyright (c) Patrick Dinklage
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+#include "progress.hpp"
+
+namespace repetitiveness {
+
+// collects the histogram of LCP values that the substring complexity is computed from -- courtesy of regindex/substring-complexity (MIT license)
+// the histogram uses 64-bit counters for small values, larger values are counted in a tail of 32-bit counters that is
+// only as long as the largest value requires, and a counter that wraps around is carried into a list
+// nb: on repetitive inputs, most LCP values are large, but they mostly fall into a range far smaller than the input
+class LCPHistogram {
+private:
+    static constexpr size_t DENSE = size_t(1) << 16;
+
+    std::vector<uint64_t> dk_;
+    std::vector<uint32_t> tail_; // the counters for values of k from DENSE on
+    std::vector<size_t> carries_; // the values of k whose tail counter wrapped around, once per wrap
+
+public:
+    LCPHistogram() : dk_(DENSE, 0) {
+    }
+
+    void clear() {
+        std::fill(dk_.begin(), dk_.end(), 0);
+        tail_.clear();
+        carries_.clear();
+    }
+
+    void add(size_t const lcp) {
+        size_t const k = lcp + 1;
+        if(k < DENSE) {
+            ++dk_[k];
+        } else {
+            size_t const i = k - DENSE;
+            if(i >= tail_.size()) tail_.resize(i + 1, 0);
+            if(++tail_[i] == 0) carries_.push_back(k);
+        }
+    }
+
+    // computes the substring complexity of a text of length n, given that all LCP values but the first were added
+    double substring_complexity(size_t const n) const {
+        int64_t x = dk_[1];
+        double delta = x;
+        size_t const max_dense = std::min(DENSE, n);
+        for(size_t k = 2; k < max_dense; k++) {
+            x = x + dk_[k] - 1;
+            delta = std::max(delta, double(x) / k);
+        }
+
+        // there are at most n - k + 1 distinct substrings of length k, so once (n - k + 1) / k cannot exceed delta, no
+        // larger k can either
+        // beyond the tail, the histogram is zero, so x decreases by one per step and x / k cannot attain a maximum
+        std::vector<size_t> carries(carries_);
+        std::sort(carries.begin(), carries.end());
+        auto carry = carries.begin();
+        for(size_t i = 0; i < tail_.size() && DENSE + i < n; i++) {
+            size_t const k = DENSE + i;
+            if(double(n - k + 1) <= delta * k) break;
+
+            uint64_t dk_k = tail_[i];
+            for(; carry != carries.end() && *carry == k; ++carry) dk_k += uint64_t(1) << 32;
+            x = x + dk_k - 1;
+            delta = std::max(delta, double(x) / k);
+        }
+        return delta;
+    }
+};
+
+// computes the substring complexity from the LCP array
+// the LCP array is accessed sequentially, so it may also be streamed from disk
+template<typename LCP>
+double substring_complexity(LCP& lcp, size_t const n) {
+    LCPHistogram hist;
+    for(size_t i = 1; i < n; i++) {
+        if(i % PROGRESS_INTERVAL == 0) report_progress(i, n);
+        hist.add(lcp[i]);
+    }
+    return hist.substring_complexity(n);
+}
+
+}
@@ -0,0 +1,183 @@
+/**
+ * MIT License
+ * 
+ * Copyright (c) Patrick Dinklage
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <utility>
+#include <vector>
+
+#include "progress.hpp"
+
+namespace repetitiveness {
+
+// adds the number of occurrences of each character in text[0..n) to the histogram
+// consecutive equal characters would serialize on incrementing the same counter, so the characters are counted in four
+// interleaved tables that are merged at the end, and long texts are split into chunks that are counted in parallel
+inline void byte_histogram(uint8_t const* text, size_t const n, size_t* hist) {
+    static constexpr size_t CHUNK_SIZE = size_t(1) << 20;
+
+    auto count = [](uint8_t const* s, size_t const m, size_t* out){
+        size_t tables[4][256] = {};
+        size_t i = 0;
+        for(; i + 8 <= m; i += 8) {
+            uint64_t w;
+            std::memcpy(&w, s + i, sizeof(w));
+            for(size_t k = 0; k < 8; k++) ++tables[k % 4][(w >> (8 * k)) & 0xFF];
+        }
+        for(; i < m; i++) ++tables[0][s[i]];
+        for(size_t c = 0; c < 256; c++) out[c] += tables[0][c] + tables[1][c] + tables[2][c] + tables[3][c];
+    };
+
+    if(n <= CHUNK_SIZE) {
+        count(text, n, hist);
+        return;
+    }
+
+    size_t const num_chunks = (n + CHUNK_SIZE - 1) / CHUNK_SIZE;
+    #pragma omp parallel
+    {
+        size_t local[256] = {};
+
+        #pragma omp for schedule(static)
+        for(size_t b = 0; b < num_chunks; b++) {
+            size_t const offset = b * CHUNK_SIZE;
+            count(text + offset, std::min(CHUNK_SIZE, n - offset), local);
+        }
+
+        #pragma omp critical
+        for(size_t c = 0; c < 256; c++) hist[c] += local[c];
+    }
+}
+
+// computes the alphabet size and the zeroth-order empirical entropy from the histogram of a text of length n
+inline std::pair<size_t, double> histogram_entropy(size_t const* hist, size_t const n) {
+    size_t sigma = 0;
+    double h0 = 0;
+    for(size_t c = 0; c < 256; c++) {
+        auto const nc = hist[c];
+        if(nc) {
+            ++sigma;
+            h0 += (double(nc) / double(n)) * std::log2(double(n) / double(nc));
+        }
+    }
+    return { sigma, h0 };
+}
+
+// computes the alphabet size and the zeroth-order empirical entropy of each of the given prefixes of the text in a
+// single pass, the prefix lengths must be ascending
+inline std::vector<std::pair<size_t, double>> alphabet_entropy_prefixes(uint8_t const* text, std::vector<size_t> const& prefixes) {
+    std::vector<std::pair<size_t, double>> results;
+    results.reserve(prefixes.size());
+
+    size_t hist[256];
+    for(size_t c = 0; c < 256; c++) hist[c] = 0;
+
+    size_t i = 0;
+    for(auto const n : prefixes) {
+        byte_histogram(text + i, n - i, hist);
+        i = n;
+        results.push_back(histogram_entropy(hist, n));
+    }
+    return results;
+}
+
+// computes the alphabet size and the zeroth-order empirical entropy of the text
+inline std::pair<size_t, double> alphabet_entropy(uint8_t const* text, size_t const n) {
+    return alphabet_entropy_prefixes(text, { n })[0];
+}
+
+// computes the k-th order empirical entropy of the text for each of the given orders k in a single pass over the SA and
+// LCP array, where the text is terminated by the sentinel
+// the context of a character are the k characters following it, so the characters sharing a context are the BWT
+// characters of a range of suffixes with a common prefix of length k, i.e., in which all LCP values but the first are at
+// least k, and characters followed by fewer than k characters have no context and are not counted
+// nb: this is the entropy with respect to the following context, which equals the usual H_k of the reversed text
+template<typename SA, typename LCP>
+std::vector<double> higher_order_entropy(uint8_t const* text, SA& sa, LCP& lcp, std::vector<size_t> const& ks) {
+    // x log x for small x is looked up
+    static constexpr size_t XLOGX_SMALL = 4096;
+    static auto const xlogx_table = [](){
+        std::vector<double> table(XLOGX_SMALL);
+        for(size_t x = 1; x < XLOGX_SMALL; x++) table[x] = double(x) * std::log2(double(x));
+        return table;
+    }();
+    auto xlogx = [&](size_t const x){ return x < XLOGX_SMALL ? xlogx_table[x] : double(x) * std::log2(double(x)); };
+
+    // the character counts of the current context of an order, which are valid only if stamped with the context's number,
+    // so they need not be cleared between contexts
+    struct Context {
+        size_t count[256];
+        size_t stamp[256];
+        size_t number = 1;
+        size_t size = 0;
+        double sum = 0; // the sum of count log count over all characters
+        double total = 0; // the sum of size H_0 over all previous contexts
+    };
+
+    size_t const n = sa.size();
+    size_t const num_ks = ks.size();
+    std::vector<Context> contexts(num_ks);
+    for(auto& ctx : contexts) std::fill(ctx.stamp, ctx.stamp + 256, 0);
+
+    auto close = [&](Context& ctx){
+        ctx.total += xlogx(ctx.size) - ctx.sum;
+        ctx.size = 0;
+        ctx.sum = 0;
+        ++ctx.number;
+    };
+
+    for(size_t i = 0; i < n; i++) {
+        if(i % PROGRESS_INTERVAL == 0) report_progress(i, n);
+        size_t const j = sa[i];
+        size_t const l = i > 0 ? size_t(lcp[i]) : 0;
+        size_t const len = n - 1 - j; // not taking into account the sentinel
+        uint8_t const c = j > 0 ? text[j - 1] : 0;
+        for(size_t x = 0; x < num_ks; x++) {
+            auto& ctx = contexts[x];
+            if(l < ks[x]) close(ctx);
+            if(j > 0 && len >= ks[x]) {
+                if(ctx.stamp[c] != ctx.number) {
+                    ctx.stamp[c] = ctx.number;
+                    ctx.count[c] = 0;
+                }
+                auto const nc = ++ctx.count[c];
+                ctx.sum += xlogx(nc) - xlogx(nc - 1);
+                ++ctx.size;
+            }
+        }
+    }
+
+    std::vector<double> hk(num_ks);
+    for(size_t x = 0; x < num_ks; x++) {
+        close(contexts[x]);
+        hk[x] = n > 1 ? contexts[x].total / double(n - 1) : 0;
+    }
+    return hk;
+}
+
+}
@@ -0,0 +1,105 @@
+/**
+ * MIT License
+ * 
+ * Copyright (c) Patrick Dinklage
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+#include "writer.hpp"
+
+namespace repetitiveness {
+
+// writes an LZ77 factorization passed on by lz77_lcp or lz77_psv to a file
+// the file starts with the eight bytes "LZ77F001" and the text length as a 64-bit word, followed by one record per
+// factor: the factor length and the distance to its source as varints, or zero and the character for a literal factor,
+// and it ends with the number of factors as a 64-bit word
+// all words are little-endian
+class LZ77Writer {
+private:
+    BinaryWriter out_;
+    uint8_t const* text_;
+    size_t n_;
+    size_t count_ = 0;
+
+public:
+    // n is the length of the text including the sentinel, which marks literal factors as their source
+    LZ77Writer(std::string const& path, uint8_t const* text, size_t const n) : out_(path), text_(text), n_(n) {
+        static constexpr char MAGIC[] = "LZ77F001";
+        for(size_t k = 0; k < 8; k++) out_.put(uint8_t(MAGIC[k]));
+        out_.put_u64(n - 1);
+    }
+
+    void operator()(size_t const i, size_t const len, size_t const src) {
+        if(src == n_) {
+            out_.put_varint(0);
+            out_.put(text_[i]);
+        } else {
+            out_.put_varint(len);
+            out_.put_varint(i - src);
+        }
+        ++count_;
+    }
+
+    // writes the end of the file and reports whether the whole file could be written
+    bool close() {
+        out_.put_u64(count_);
+        return out_.close();
+    }
+};
+
+// writes an LZ78 factorization passed on by lz78_prefixes to a file
+// the file starts with the eight bytes "LZ78F001" and the text length as a 64-bit word, followed by one record per
+// phrase: the number of the phrase it extends as a varint and its last character, and it ends with the number of these
+// phrases and the number of the earlier phrase equal to the final phrase, or zero if there is no such phrase, as 64-bit
+// words
+// all words are little-endian
+class LZ78Writer {
+private:
+    BinaryWriter out_;
+    size_t count_ = 0;
+
+public:
+    LZ78Writer(std::string const& path, size_t const n) : out_(path) {
+        static constexpr char MAGIC[] = "LZ78F001";
+        for(size_t k = 0; k < 8; k++) out_.put(uint8_t(MAGIC[k]));
+        out_.put_u64(n);
+    }
+
+    void operator()(size_t const parent, uint8_t const c) {
+        out_.put_varint(parent);
+        out_.put(c);
+        ++count_;
+    }
+
+    // writes the end of the file and reports whether the whole file could be written
+    bool close(size_t const final_phrase) {
+        out_.put_u64(count_);
+        out_.put_u64(final_phrase);
+        return out_.close();
+    }
+};
+
+}
@@ -0,0 +1,176 @@
+/**
+ * MIT License
+ * 
+ * Copyright (c) Patrick Dinklage
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <span>
+#include <string>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace repetitiveness {
+
+// computes a 64-bit hash of the given data, processing eight bytes per step (not cryptographically secure)
+inline uint64_t content_hash(uint8_t const* data, size_t const n) {
+    static constexpr uint64_t C1 = 0x87C37B91114253D5ULL;
+    static constexpr uint64_t C2 = 0x4CF5AD432745937FULL;
+
+    auto mix = [](uint64_t h, uint64_t k) {
+        k *= C1;
+        k = (k << 31) | (k >> 33);
+        k *= C2;
+        h ^= k;
+        h = (h << 27) | (h >> 37);
+        return h * 5 + 0x52DCE729;
+    };
+
+    uint64_t h = n;
+    size_t i = 0;
+    for(; i + 8 <= n; i += 8) {
+        uint64_t k;
+        std::memcpy(&k, data + i, sizeof(k));
+        h = mix(h, k);
+    }
+    if(i < n) {
+        uint64_t k = 0;
+        std::memcpy(&k, data + i, n - i);
+        h = mix(h, k);
+    }
+
+    // finalize
+    h ^= h >> 33;
+    h *= 0xFF51AFD7ED558CCDULL;
+    h ^= h >> 33;
+    h *= 0xC4CEB9FE1A85EC53ULL;
+    h ^= h >> 33;
+    return h;
+}
+
+// a read-only array mapped from a file
+template<typename T>
+class MappedArray {
+private:
+    void* addr_ = nullptr;
+    size_t bytes_ = 0;
+
+public:
+    MappedArray() = default;
+    MappedArray(MappedArray const&) = delete;
+    MappedArray& operator=(MappedArray const&) = delete;
+
+    ~MappedArray() {
+        reset();
+    }
+
+    // maps the given file, which must contain exactly n elements, and reports whether that succeeded
+    bool map(std::string const& path, size_t const n) {
+        reset();
+
+        int const fd = open(path.c_str(), O_RDONLY);
+        if(fd < 0) return false;
+
+        struct stat st;
+        if(fstat(fd, &st) != 0 || size_t(st.st_size) != n * sizeof(T) || n == 0) {
+            close(fd);
+            return false;
+        }
+
+        auto* addr = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        close(fd);
+        if(addr == MAP_FAILED) return false;
+
+        addr_ = addr;
+        bytes_ = st.st_size;
+        return true;
+    }
+
+    void reset() {
+        if(addr_) munmap(addr_, bytes_);
+        addr_ = nullptr;
+        bytes_ = 0;
+    }
+
+    std::span<T const> span() const { return { (T const*)addr_, bytes_ / sizeof(T) }; }
+};
+
+// a persistent cache for the arrays constructed for an input, which is identified by a hash of its content and length
+// the arrays are stored in files named after that identifier in the cache directory
+class IndexCache {
+private:
+    std::string dir_;
+    std::string id_;
+
+public:
+    IndexCache(std::string const& dir, uint8_t const* text, size_t const n) : dir_(dir) {
+        char hash[17];
+        std::snprintf(hash, sizeof(hash), "%016llx", (unsigned long long)content_hash(text, n));
+        id_ = std::string(hash) + "-" + std::to_string(n);
+    }
+
+    std::string const& dir() const { return dir_; }
+    std::string const& id() const { return id_; }
+
+    // the file holding the array of the given name, whose entries have the given number of bits
+    std::string path(std::string const& name, size_t const bits) const {
+        return (std::filesystem::path(dir_) / (id_ + "." + name + std::to_string(bits))).string();
+    }
+
+    // maps the cached array of the given name, if present
+    template<typename T>
+    bool load(std::string const& name, size_t const n, MappedArray<T>& out) const {
+        return out.map(path(name, 8 * sizeof(T)), n);
+    }
+
+    // stores the array of the given name, which is written to a temporary file that is renamed when complete,
+    // so that concurrent runs never see partial arrays
+    template<typename T>
+    bool store(std::string const& name, std::span<T const> data) const {
+        std::error_code ec;
+        std::filesystem::create_directories(dir_, ec);
+
+        auto const final_path = path(name, 8 * sizeof(T));
+        auto const tmp_path = final_path + ".tmp" + std::to_string(getpid());
+        {
+            std::ofstream out(tmp_path, std::ios::binary);
+            out.write((char const*)data.data(), data.size() * sizeof(T));
+            if(!out) {
+                std::filesystem::remove(tmp_path, ec);
+                return false;
+            }
+        }
+        std::filesystem::rename(tmp_path, final_path, ec);
+        return !ec;
+    }
+};
+
+}
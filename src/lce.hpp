@@ -0,0 +1,55 @@
+/**
+ * MIT License
+ * 
+ * Copyright (c) Patrick Dinklage
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+
+namespace repetitiveness {
+
+// computes the length of the longest common prefix of text[i..n) and text[j..n)
+// compares 32 bytes per step as four 64-bit words and locates the first mismatch via the lowest set bit
+inline size_t lce(uint8_t const* text, size_t const n, size_t const i, size_t const j) {
+    auto word = [&](size_t const x) {
+        uint64_t w;
+        std::memcpy(&w, text + x, sizeof(w));
+        return w;
+    };
+
+    size_t l = 0;
+    size_t const max_l = n - std::max(i, j);
+    while(l + 32 <= max_l) {
+        for(size_t k = 0; k < 4; k++) {
+            auto const x = word(i + l) ^ word(j + l);
+            if(x) return l + (__builtin_ctzll(x) >> 3);
+            l += 8;
+        }
+    }
+    while(l < max_l && text[i + l] == text[j + l]) ++l;
+    return l;
+}
+
+}
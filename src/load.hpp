@@ -0,0 +1,94 @@
+/**
+ * MIT License
+ * 
+ * Copyright (c) Patrick Dinklage
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "entropy.hpp"
+
+namespace repetitiveness {
+
+// reads len bytes starting at the given offset of the file in bulk
+inline bool read_fully(int const fd, char* data, size_t const len, size_t const offset) {
+    for(size_t num_read = 0; num_read < len;) {
+        auto const r = pread(fd, data + num_read, std::min(len - num_read, size_t(1) << 30), offset + num_read);
+        if(r <= 0) return false;
+        num_read += r;
+    }
+    return true;
+}
+
+// reads the file (or the requested prefix) in bulk directly into the given buffer, followed by the sentinel
+// a zero byte at the very end of the file is taken as the sentinel, which is appended unless present, and other zero
+// bytes are regular characters, including one that ends the requested prefix
+// returns nullptr on success, and otherwise a description of the error
+template<typename Buffer>
+char const* load_text(std::string const& file, size_t const max_len, Buffer& text) {
+    int const fd = open(file.c_str(), O_RDONLY);
+    struct stat st;
+    if(fd < 0 || fstat(fd, &st) != 0) {
+        if(fd >= 0) close(fd);
+        return "cannot open the input file";
+    }
+
+    size_t const len = std::min(size_t(st.st_size), max_len);
+    if(len == 0) {
+        close(fd);
+        return "the input is empty";
+    }
+
+    text.resize(len + 1);
+    auto* data = (char*)text.data();
+    data[len] = 0;
+    bool const ok = read_fully(fd, data, len, 0);
+    close(fd);
+    if(!ok) return "cannot read the input file";
+
+    if(len == size_t(st.st_size) && data[len - 1] == 0) text.resize(len);
+    return nullptr;
+}
+
+// maps each character occurring in the text of length n to its rank in the alphabet plus one, which frees zero for the
+// sentinel and preserves the lexicographic order of all suffixes
+// returns false if all 256 byte values occur, in which case the ranks do not fit into a byte
+inline bool shifted_alphabet(uint8_t const* text, size_t const n, uint8_t* map) {
+    size_t hist[256] = {};
+    byte_histogram(text, n, hist);
+
+    size_t rank = 0;
+    for(size_t c = 0; c < 256; c++) {
+        if(hist[c]) map[c] = uint8_t(++rank);
+    }
+    return rank < 256;
+}
+
+}
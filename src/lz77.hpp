@@ -0,0 +1,154 @@
+/**
+ * MIT License
+ * 
+ * Copyright (c) Patrick Dinklage
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "lce.hpp"
+#include "progress.hpp"
+
+namespace repetitiveness {
+
+// receives the factors of a factorization, which is discarded by default
+// each factor is given by its starting position, its length and the starting position of its source, which is the
+// text length for a literal factor of length one
+struct IgnoreFactors {
+    void operator()(size_t, size_t, size_t) const {}
+};
+
+// counts the LZ77 factors of each of the given prefixes of the text, the prefix lengths must be ascending
+// factor reports the length of the factor starting at a text position of the whole text's factorization and the
+// starting position of its source (or n if there is none), and each factor is passed on to the given receiver
+// the factorization of a prefix only differs from that in the factor that crosses the prefix's end, which is truncated,
+// so a prefix has as many factors as start inside of it
+// the progress is reported as the second half of processing the text of length n, following the sweep over the SA
+template<typename Factor, typename FactorFunc>
+std::vector<size_t> count_factors(size_t const n, std::vector<size_t> const& prefixes, Factor&& factor, FactorFunc&& on_factor) {
+    std::vector<size_t> z77s;
+    z77s.reserve(prefixes.size());
+
+    size_t z77 = 0;
+    size_t i = 0;
+    for(auto const end : prefixes) {
+        while(i < end) {
+            if(z77 % PROGRESS_INTERVAL == 0) report_progress(n + i, 2 * n);
+            auto const [len, src] = factor(i);
+            on_factor(i, len, src);
+            i += len;
+            ++z77;
+        }
+        z77s.push_back(z77);
+    }
+    return z77s;
+}
+
+// counts the LZ77 factors by obtaining the longest previous factor (LPF) at each text position from the LCP array
+// for every suffix, the previous and next smaller values (PSV and NSV) are computed in a single sweep over the SA
+// the PSV chain of the previous suffix serves as the stack, and every suffix popped from it has found its NSV
+// the LCE with the PSV and NSV is the minimum LCP value in between, which is maintained during the sweep
+// like in the algorithms by Kaerkkaeinen, Kempa and Puglisi, all arrays are indexed by text position, so the
+// factorization needs no ISA and the SA and LCP array are only accessed sequentially, and may be streamed from disk
+// the factors are counted for each of the given prefixes, the last of which must be the whole text without the sentinel,
+// and the factors of the whole text are passed on to the given receiver
+template<typename Index, typename SA, typename LCP, typename FactorFunc = IgnoreFactors>
+std::vector<size_t> lz77_lcp(SA& sa, LCP& lcp, std::vector<size_t> const& prefixes, FactorFunc&& on_factor = {}) {
+    size_t const n = sa.size();
+
+    // suffixes that have no PSV are marked by n
+    // lpf holds the LCE with the PSV until the NSV is found, then the maximum of both
+    // once a suffix is popped from the stack, its PSV is no longer needed, so it is replaced by the NSV if that is the
+    // source of the factor
+    std::vector<Index> psv(n);
+    std::vector<Index> lpf(n);
+    size_t prev = n;
+    for(size_t p = 0; p < n; p++) {
+        if(p % PROGRESS_INTERVAL == 0) report_progress(p, 2 * n);
+        size_t const i = sa[p];
+        size_t top = prev;
+        size_t min_lcp = p > 0 ? size_t(lcp[p]) : 0;
+        while(top != n && top > i) {
+            size_t const psv_lcp = lpf[top];
+            size_t const next = psv[top];
+            if(min_lcp > psv_lcp) {
+                lpf[top] = min_lcp;
+                psv[top] = i;
+            }
+            min_lcp = std::min(min_lcp, psv_lcp);
+            top = next;
+        }
+        psv[i] = top;
+        lpf[i] = top != n ? min_lcp : 0;
+        prev = i;
+    }
+
+    return count_factors(n, prefixes, [&](size_t const i){
+        size_t const len = lpf[i];
+        return std::pair(std::max(size_t(1), len), len > 0 ? size_t(psv[i]) : n); // nb: LPF may be zero
+    }, on_factor);
+}
+
+// counts the LZ77 factors by comparing the characters of each factor with its PSV and NSV
+// the PSV and NSV are computed like in lz77_lcp, so the SA is only accessed sequentially as well
+// the factors are counted for each of the given prefixes, the last of which must be the whole text without the sentinel,
+// and the factors of the whole text are passed on to the given receiver
+template<typename Index, typename SA, typename FactorFunc = IgnoreFactors>
+std::vector<size_t> lz77_psv(uint8_t const* text, SA& sa, std::vector<size_t> const& prefixes, FactorFunc&& on_factor = {}) {
+    size_t const n = sa.size();
+    size_t const actual_n = prefixes.back();
+
+    // suffixes that have no PSV or NSV are marked by n
+    std::vector<Index> psv(n);
+    std::vector<Index> nsv(n, n);
+    size_t prev = n;
+    for(size_t p = 0; p < n; p++) {
+        if(p % PROGRESS_INTERVAL == 0) report_progress(p, 2 * n);
+        size_t const i = sa[p];
+        size_t top = prev;
+        while(top != n && top > i) {
+            nsv[top] = i;
+            top = psv[top];
+        }
+        psv[i] = top;
+        prev = i;
+    }
+
+    return count_factors(n, prefixes, [&](size_t const i){
+        size_t const psv_i = psv[i];
+        size_t const psv_lcp = psv_i != n ? lce(text, actual_n, i, psv_i) : 0;
+
+        size_t const nsv_i = nsv[i];
+        size_t const nsv_lcp = nsv_i != n ? lce(text, actual_n, i, nsv_i) : 0;
+
+        // select maximum
+        auto const max_lcp = std::max(psv_lcp, nsv_lcp); // nb: may be zero
+        auto const src = max_lcp == 0 ? n : (psv_lcp >= nsv_lcp ? psv_i : nsv_i);
+        return std::pair(std::max(size_t(1), max_lcp), src);
+    }, on_factor);
+}
+
+}
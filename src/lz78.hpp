@@ -0,0 +1,491 @@
+/**
+ * MIT License
+ * 
+ * Copyright (c) Patrick Dinklage
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include <omp.h>
+
+#include "progress.hpp"
+
+namespace repetitiveness {
+
+// growable array that allocates memory in chunks of 2^CHUNK_BITS elements
+// growing never moves existing elements, so unlike with std::vector, the memory does not temporarily double
+// and the memory usage exceeds the size of the contained elements by less than one chunk
+template<typename T, size_t CHUNK_BITS = 16>
+class ChunkedArray {
+private:
+    static constexpr size_t CHUNK_SIZE = size_t(1) << CHUNK_BITS;
+    static constexpr size_t CHUNK_MASK = CHUNK_SIZE - 1;
+
+    std::vector<std::unique_ptr<T[]>> chunks_;
+    size_t size_ = 0;
+
+public:
+    // appends the given number of copies of the value and returns the index of the first
+    size_t append(T const& x, size_t const count = 1) {
+        auto const first = size_;
+        for(size_t k = 0; k < count; k++) {
+            if(size_ == chunks_.size() * CHUNK_SIZE) chunks_.push_back(std::make_unique_for_overwrite<T[]>(CHUNK_SIZE));
+            (*this)[size_++] = x;
+        }
+        return first;
+    }
+
+    T& operator[](size_t const i) { return chunks_[i >> CHUNK_BITS][i & CHUNK_MASK]; }
+    T const& operator[](size_t const i) const { return chunks_[i >> CHUNK_BITS][i & CHUNK_MASK]; }
+
+    size_t size() const { return size_; }
+
+    // removes all elements, but keeps the allocated chunks for reuse
+    void clear() { size_ = 0; }
+
+    // the number of bytes allocated
+    size_t memory() const { return chunks_.size() * CHUNK_SIZE * sizeof(T) + chunks_.capacity() * sizeof(chunks_[0]); }
+};
+
+// LZ78 trie storing the children of each node in a singly linked list, which is reordered on access (move to front)
+class ListTrie {
+public:
+    using Character = uint8_t;
+    using NodeNumber = size_t;
+
+private:
+    static constexpr NodeNumber NIL = -1;
+    static constexpr NodeNumber ROOT = 0;
+
+    struct Node {
+        Character label;
+        NodeNumber first_child;
+        NodeNumber next_sibling;
+    } __attribute__((packed));
+
+    ChunkedArray<Node> nodes_;
+
+    NodeNumber create_node(Character const label) {
+        return nodes_.append(Node{label, NIL, NIL});
+    }
+
+public:
+    ListTrie() {
+        create_node(0); // root
+    }
+
+    // removes all nodes but the root, keeping the allocated memory for reuse
+    void clear() {
+        nodes_.clear();
+        create_node(0);
+    }
+
+    bool try_get_child(NodeNumber const u, Character const c, NodeNumber& out) {
+        NodeNumber prev = NIL;
+        auto v = nodes_[u].first_child;
+        while(v != NIL) {
+            if(nodes_[v].label == c) {
+                // move to front
+                if(prev != NIL) {
+                    nodes_[prev].next_sibling = nodes_[v].next_sibling;
+                    nodes_[v].next_sibling = nodes_[u].first_child;
+                    nodes_[u].first_child = v;
+                }
+
+                // return
+                out = v;
+                return true;
+            }
+            prev = v;
+            v = nodes_[v].next_sibling;
+        }
+        return false;
+    }
+
+    NodeNumber insert_child(NodeNumber const u, Character const c) {
+        auto const v = create_node(c);
+        nodes_[v].next_sibling = nodes_[u].first_child;
+        nodes_[u].first_child = v;
+        return v;
+    }
+
+    NodeNumber root() const { return ROOT; }
+
+    size_t memory() const { return nodes_.memory(); }
+};
+
+// LZ78 trie storing all edges in a single hash table keyed by the parent node and the label, using linear probing
+// nodes are numbered consecutively and are not stored explicitly
+class HashTrie {
+public:
+    using Character = uint8_t;
+    using NodeNumber = size_t;
+
+private:
+    static constexpr NodeNumber ROOT = 0;
+    static constexpr uint64_t EMPTY = 0;
+
+    // the table is grown when it is filled to this fraction (in 1/256)
+    static constexpr size_t MAX_LOAD = 192;
+
+    struct Entry {
+        uint64_t key; // (parent node + 1) * 256 + label, or EMPTY
+        NodeNumber child;
+    };
+
+    std::vector<Entry> table_;
+    size_t mask_;
+    size_t size_; // number of nodes, including the root
+
+    static uint64_t key(NodeNumber const u, Character const c) {
+        return ((uint64_t(u) + 1) << 8) | c;
+    }
+
+    size_t slot(uint64_t const k) const {
+        // Fibonacci hashing
+        return ((k * 0x9E3779B97F4A7C15ULL) >> 20) & mask_;
+    }
+
+    void grow() {
+        std::vector<Entry> old(2 * table_.size(), Entry{EMPTY, 0});
+        std::swap(table_, old);
+        mask_ = table_.size() - 1;
+        for(auto const& e : old) {
+            if(e.key != EMPTY) {
+                auto i = slot(e.key);
+                while(table_[i].key != EMPTY) i = (i + 1) & mask_;
+                table_[i] = e;
+            }
+        }
+    }
+
+public:
+    HashTrie() : table_(1024, Entry{EMPTY, 0}), mask_(1023), size_(1) {
+    }
+
+    // removes all nodes but the root, keeping the allocated memory for reuse
+    void clear() {
+        std::fill(table_.begin(), table_.end(), Entry{EMPTY, 0});
+        size_ = 1;
+    }
+
+    bool try_get_child(NodeNumber const u, Character const c, NodeNumber& out) const {
+        auto const k = key(u, c);
+        for(auto i = slot(k); table_[i].key != EMPTY; i = (i + 1) & mask_) {
+            if(table_[i].key == k) {
+                out = table_[i].child;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    NodeNumber insert_child(NodeNumber const u, Character const c) {
+        if(256 * (size_ + 1) > MAX_LOAD * table_.size()) grow();
+
+        auto const v = size_++;
+        auto const k = key(u, c);
+        auto i = slot(k);
+        while(table_[i].key != EMPTY) i = (i + 1) & mask_;
+        table_[i] = Entry{k, v};
+        return v;
+    }
+
+    NodeNumber root() const { return ROOT; }
+
+    size_t memory() const { return table_.capacity() * sizeof(Entry); }
+};
+
+// LZ78 trie that, like ListTrie, stores children in move-to-front lists, but switches to an array indexed by the label
+// once a node has DENSE_FANOUT children, so that the high-fanout nodes near the root are navigated in constant time
+class HybridTrie {
+public:
+    using Character = uint8_t;
+    using NodeNumber = size_t;
+
+private:
+    static constexpr NodeNumber NIL = -1;
+    static constexpr NodeNumber ROOT = 0;
+
+    static constexpr uint8_t DENSE_FANOUT = 32;
+    static constexpr uint8_t DENSE = UINT8_MAX; // fanout marker of nodes using a child array
+
+    struct Node {
+        Character label;
+        uint8_t fanout; // number of children, or DENSE
+        NodeNumber first_child; // for dense nodes, the offset of the child array in dense_
+        NodeNumber next_sibling;
+    } __attribute__((packed));
+
+    ChunkedArray<Node> nodes_;
+    ChunkedArray<NodeNumber> dense_;
+
+    NodeNumber create_node(Character const label) {
+        return nodes_.append(Node{label, 0, NIL, NIL});
+    }
+
+    void make_dense(NodeNumber const u) {
+        auto const offset = dense_.append(NIL, 256);
+        for(auto v = nodes_[u].first_child; v != NIL; v = nodes_[v].next_sibling) {
+            dense_[offset + nodes_[v].label] = v;
+        }
+        nodes_[u].fanout = DENSE;
+        nodes_[u].first_child = offset;
+    }
+
+public:
+    HybridTrie() {
+        create_node(0); // root
+    }
+
+    // removes all nodes but the root, keeping the allocated memory for reuse
+    void clear() {
+        nodes_.clear();
+        dense_.clear();
+        create_node(0);
+    }
+
+    bool try_get_child(NodeNumber const u, Character const c, NodeNumber& out) {
+        if(nodes_[u].fanout == DENSE) {
+            auto const v = dense_[nodes_[u].first_child + c];
+            if(v == NIL) return false;
+
+            out = v;
+            return true;
+        }
+
+        NodeNumber prev = NIL;
+        auto v = nodes_[u].first_child;
+        while(v != NIL) {
+            if(nodes_[v].label == c) {
+                // move to front
+                if(prev != NIL) {
+                    nodes_[prev].next_sibling = nodes_[v].next_sibling;
+                    nodes_[v].next_sibling = nodes_[u].first_child;
+                    nodes_[u].first_child = v;
+                }
+
+                // return
+                out = v;
+                return true;
+            }
+            prev = v;
+            v = nodes_[v].next_sibling;
+        }
+        return false;
+    }
+
+    NodeNumber insert_child(NodeNumber const u, Character const c) {
+        auto const v = create_node(c);
+        if(nodes_[u].fanout == DENSE) {
+            dense_[nodes_[u].first_child + c] = v;
+        } else {
+            nodes_[v].next_sibling = nodes_[u].first_child;
+            nodes_[u].first_child = v;
+            if(++nodes_[u].fanout == DENSE_FANOUT) make_dense(u);
+        }
+        return v;
+    }
+
+    NodeNumber root() const { return ROOT; }
+
+    size_t memory() const { return nodes_.memory() + dense_.memory(); }
+};
+
+// receives the phrases of an LZ78 factorization, which is discarded by default
+// each phrase is given by the number of the phrase it extends (zero for the empty phrase) and its last character, and
+// the phrases are numbered from one in order of occurrence
+struct IgnorePhrases {
+    void operator()(size_t, uint8_t) const {}
+};
+
+// counts the LZ78 factors of each of the given prefixes of the text in a single pass, the prefix lengths must be ascending
+// the factorization of a prefix only differs from that of the whole text in its final phrase, which is truncated
+// the given trie must be empty, and the memory allocated for it is reported
+// every complete phrase is passed on to the given receiver, and the trie node reached by the final phrase of the text
+// is reported, which is the root unless that phrase is incomplete, i.e., equal to an earlier phrase
+// nb: each trie numbers its nodes in order of insertion, starting with zero for the root, so phrases are numbered by the
+//     node they insert
+template<typename Trie, typename PhraseFunc = IgnorePhrases>
+std::vector<size_t> lz78_prefixes(Trie& trie, uint8_t const* text, std::vector<size_t> const& prefixes, size_t& trie_memory,
+                                  PhraseFunc&& on_phrase = {}, size_t* final_phrase = nullptr) {
+    std::vector<size_t> z78s;
+    z78s.reserve(prefixes.size());
+
+    size_t z78 = 0;
+    auto v = trie.root();
+    size_t i = 0;
+    for(auto const end : prefixes) {
+        for(; i < end; i++) {
+            auto const c = text[i];
+            if(!trie.try_get_child(v, c, v)) {
+                trie.insert_child(v, c);
+                on_phrase(size_t(v), c);
+                v = trie.root();
+                if(++z78 % PROGRESS_INTERVAL == 0) report_progress(i, prefixes.back());
+            }
+        }
+        z78s.push_back(z78 + (v != trie.root() ? 1 : 0)); // final phrase
+    }
+
+    trie_memory = trie.memory();
+    if(final_phrase) *final_phrase = size_t(v);
+    return z78s;
+}
+
+// counts the LZ78 factors using the given trie implementation and reports the memory allocated for the trie
+template<typename Trie>
+size_t lz78(uint8_t const* text, size_t const n, size_t& trie_memory) {
+    Trie trie;
+    return lz78_prefixes(trie, text, { n }, trie_memory)[0];
+}
+
+// an estimate of the number of LZ78 factors
+struct LZ78Estimate {
+    size_t z78;
+    double error; // the relative error of the approximation measured on the sample
+};
+
+// estimates the number of LZ78 factors in parallel and reports the memory allocated for the tries
+// a sample prefix of the text is factorized exactly, and the remaining text is then factorized in rounds of one chunk
+// per thread: the threads factorize their chunks independently against the trie shared read-only among them, each
+// extending it by a private trie, and after each round, the new phrases of the chunks are merged into the shared trie
+// in order, so that the next round knows them
+// because a chunk misses the phrases of the concurrent chunks before it and starts a phrase at its first character, the
+// chunk counts are inexact; to calibrate them, the end of the sample is factorized like a chunk against the trie
+// missing as many phrases as a chunk would, and the chunk counts are scaled by the ratio of the exact and approximate
+// counts there, whose relative difference is reported as the error
+// nb: the error is an indication, not a bound: a single shifted phrase boundary may change the factorization arbitrarily
+// nb: the chunks depend on the number of threads, and so does the estimate
+inline LZ78Estimate lz78_estimate(uint8_t const* text, size_t const n, size_t& trie_memory) {
+    static constexpr size_t MIN_SAMPLE = size_t(1) << 20;
+    static constexpr size_t MIN_CHUNK = size_t(1) << 16;
+
+    size_t const num_threads = omp_get_max_threads();
+    size_t const sample = std::min(n, std::max(MIN_SAMPLE, n / 16));
+    size_t const chunk_size = std::max(MIN_CHUNK, sample / (2 * num_threads));
+    size_t const calibration = std::min(chunk_size, sample / 2);
+    size_t const calibration_gap = std::min(sample - calibration, (num_threads - 1) * chunk_size);
+
+    // factorize the sample exactly, the trie numbers its nodes in order of insertion
+    // nb: the phrase crossing the end of the sample is counted by the first chunk
+    HashTrie shared;
+    size_t num_nodes = 1; // including the root
+    size_t calibration_nodes = 1; // the nodes preceding the calibration part and the concurrent chunks before it
+    size_t calibration_start_nodes = 1;
+    HashTrie::NodeNumber v = shared.root();
+    for(size_t i = 0; i < sample; i++) {
+        if(i == sample - calibration - calibration_gap) calibration_nodes = num_nodes;
+        if(i == sample - calibration) calibration_start_nodes = num_nodes;
+        if(!shared.try_get_child(v, text[i], v)) {
+            shared.insert_child(v, text[i]);
+            if(++num_nodes % PROGRESS_INTERVAL == 0) report_progress(i, n);
+            v = shared.root();
+        }
+    }
+    if(sample == n) {
+        trie_memory = shared.memory();
+        return { num_nodes - 1 + (v != shared.root() ? 1 : 0), 0 };
+    }
+
+    // factorizes a part of the text against the shared nodes numbered less than the limit and the given private trie,
+    // whose nodes are numbered after the shared ones, and records the new phrases by their parent and character
+    struct Phrase {
+        HashTrie::NodeNumber parent;
+        uint8_t c;
+    };
+    auto factorize = [&](uint8_t const* s, size_t const m, size_t const limit, HashTrie& own, std::vector<Phrase>& phrases){
+        own.clear();
+        phrases.clear();
+        size_t const offset = num_nodes - 1;
+        HashTrie::NodeNumber u = 0;
+        for(size_t i = 0; i < m; i++) {
+            auto const c = s[i];
+            HashTrie::NodeNumber w;
+            if(u < num_nodes && shared.try_get_child(u, c, w) && w < limit) {
+                u = w;
+            } else if(own.try_get_child(u, c, w)) {
+                u = offset + w;
+            } else {
+                own.insert_child(u, c);
+                phrases.push_back(Phrase{u, c});
+                u = 0;
+            }
+        }
+        return phrases.size() + (u != 0 ? 1 : 0);
+    };
+
+    size_t const z_sample = num_nodes - 1;
+    std::vector<HashTrie> own(num_threads);
+    std::vector<std::vector<Phrase>> phrases(num_threads);
+    size_t private_memory = 0;
+
+    size_t const z_calibration = factorize(text + sample - calibration, calibration, calibration_nodes, own[0], phrases[0]);
+    size_t const z_exact = num_nodes - calibration_start_nodes;
+
+    size_t z_chunks = 0;
+    std::vector<HashTrie::NodeNumber> ids;
+    for(size_t round = sample; round < n; round += num_threads * chunk_size) {
+        report_progress(round, n);
+        size_t const num_chunks = std::min(num_threads, (n - round + chunk_size - 1) / chunk_size);
+
+        size_t const offset = num_nodes - 1; // of the private node numbers
+        std::vector<size_t> zs(num_chunks);
+        #pragma omp parallel for schedule(static, 1)
+        for(size_t x = 0; x < num_chunks; x++) {
+            size_t const start = round + x * chunk_size;
+            zs[x] = factorize(text + start, std::min(chunk_size, n - start), num_nodes, own[x], phrases[x]);
+        }
+
+        // merge the new phrases of the chunks into the shared trie, mapping private node numbers to shared ones
+        for(size_t x = 0; x < num_chunks; x++) {
+            z_chunks += zs[x];
+            private_memory = std::max(private_memory, own[x].memory());
+
+            ids.clear();
+            for(auto const& ph : phrases[x]) {
+                auto const parent = ph.parent > offset ? ids[ph.parent - offset - 1] : ph.parent;
+                HashTrie::NodeNumber w;
+                if(!shared.try_get_child(parent, ph.c, w)) {
+                    w = shared.insert_child(parent, ph.c);
+                    ++num_nodes;
+                }
+                ids.push_back(w);
+            }
+        }
+    }
+
+    double const ratio = z_calibration > 0 ? double(z_exact) / double(z_calibration) : 1.0;
+    trie_memory = shared.memory() + num_threads * private_memory;
+    return {
+        z_sample + size_t(std::llround(double(z_chunks) * ratio)),
+        z_exact > 0 ? std::abs(double(z_calibration) - double(z_exact)) / double(z_exact) : 0.0
+    };
+}
+
+}
@@ -24,254 +24,1279 @@
 
 #include <sdsl/cst_sct3.hpp>
 
-class Trie {
-public:
-    using Character = uint8_t;
-    using NodeNumber = size_t;
-
-private:
-    static constexpr NodeNumber NIL = -1;
-    static constexpr NodeNumber ROOT = 0;
-
-    struct Node {
-        Character label;
-        NodeNumber first_child;
-        NodeNumber next_sibling;
-    } __attribute__((packed));
-
-    std::vector<Node> nodes_;
-
-    NodeNumber create_node(Character const label) {
-        auto const x = nodes_.size();
-        nodes_.push_back(Node{label, NIL, NIL});
-        return x;
-    }
-
-public:
-    Trie() {
-        create_node(0); // root
-    }
-
-    bool try_get_child(NodeNumber const u, Character const c, NodeNumber& out) {
-        NodeNumber prev = NIL;
-        auto v = nodes_[u].first_child;
-        while(v != NIL) {
-            if(nodes_[v].label == c) {
-                // move to front
-                if(prev != NIL) {
-                    nodes_[prev].next_sibling = nodes_[v].next_sibling;
-                    nodes_[v].next_sibling = nodes_[u].first_child;
-                    nodes_[u].first_child = v;
-                }
+#include <atomic>
+#include <charconv>
+#include <csignal>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <future>
+#include <mutex>
+#include <optional>
+#include <random>
+#include <span>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "bwt.hpp"
+#include "delta.hpp"
+#include "entropy.hpp"
+#include "factorization.hpp"
+#include "index_cache.hpp"
+#include "load.hpp"
+#include "lz77.hpp"
+#include "lz78.hpp"
+#include "output.hpp"
+#include "phases.hpp"
+#include "plcp.hpp"
+#include "progress.hpp"
+#include "repetitiveness.hpp"
+#include "rlbwt.hpp"
+#include "sa.hpp"
+#include "sketch.hpp"
+#include "uint40.hpp"
+
+using namespace repetitiveness;
 
-                // return
-                out = v;
-                return true;
+// parses a comma-separated list of measure names into a set of measures
+bool parse_measures(std::string const& list, unsigned& out) {
+    out = 0;
+    size_t start = 0;
+    while(start <= list.size()) {
+        auto end = list.find(',', start);
+        if(end == std::string::npos) end = list.size();
+
+        auto const name = list.substr(start, end - start);
+        bool found = false;
+        for(auto const& m : MEASURES) {
+            if(name == m.name) {
+                out |= m.measure;
+                found = true;
             }
-            prev = v;
-            v = nodes_[v].next_sibling;
         }
-        return false;
+        if(!found) return false;
+        start = end + 1;
     }
+    return true;
+}
+
+// parses a non-negative decimal number, and fails if it does not fit into 64 bits
+bool parse_number(std::string const& s, uint64_t& out) {
+    if(s.empty() || !std::all_of(s.begin(), s.end(), [](char c){ return std::isdigit((unsigned char)c); })) return false;
+    auto const [end, ec] = std::from_chars(s.data(), s.data() + s.size(), out);
+    return ec == std::errc() && end == s.data() + s.size();
+}
 
-    NodeNumber insert_child(NodeNumber const u, Character const c) {
-        auto const v = create_node(c);
-        nodes_[v].next_sibling = nodes_[u].first_child;
-        nodes_[u].first_child = v;
-        return v;
+// parses a comma-separated list of positive orders for the higher-order empirical entropy
+bool parse_orders(std::string const& list, std::vector<size_t>& out) {
+    out.clear();
+    size_t start = 0;
+    while(start <= list.size()) {
+        auto end = list.find(',', start);
+        if(end == std::string::npos) end = list.size();
+
+        uint64_t k;
+        if(!parse_number(list.substr(start, end - start), k) || k == 0) return false;
+        out.push_back(k);
+        start = end + 1;
     }
+    return true;
+}
 
-    NodeNumber root() const { return ROOT; }
+// a prefix length given via --prefixes, or a geometric sequence of prefix lengths starting with it
+struct PrefixSpec {
+    size_t length;
+    size_t factor; // one for a single prefix length
 };
 
-int main(int argc, char** argv) {
-    if(argc < 2) {
-        std::cerr << "usage: " << argv[0] << " <FILE> [prefix]" << std::endl;
-        return -1;
+// parses a length with an optional binary unit suffix (K, M or G), and fails if it does not fit into 64 bits
+bool parse_length(std::string const& s, size_t& out) {
+    size_t pos = 0;
+    while(pos < s.size() && std::isdigit((unsigned char)s[pos])) ++pos;
+    if(pos == 0 || pos + 1 < s.size()) return false;
+
+    uint64_t x;
+    if(!parse_number(s.substr(0, pos), x)) return false;
+    if(pos < s.size()) {
+        unsigned shift;
+        switch(s[pos]) {
+            case 'K': shift = 10; break;
+            case 'M': shift = 20; break;
+            case 'G': shift = 30; break;
+            default: return false;
+        }
+        if(x > (UINT64_MAX >> shift)) return false;
+        x <<= shift;
     }
+    out = x;
+    return true;
+}
+
+// parses a comma-separated list of prefix lengths, each of which may be followed by *F to start a geometric sequence
+bool parse_prefixes(std::string const& list, std::vector<PrefixSpec>& out) {
+    out.clear();
+    size_t start = 0;
+    while(start <= list.size()) {
+        auto end = list.find(',', start);
+        if(end == std::string::npos) end = list.size();
 
+        auto const entry = list.substr(start, end - start);
+        auto const star = entry.find('*');
+
+        PrefixSpec spec { 0, 1 };
+        if(!parse_length(entry.substr(0, star), spec.length) || spec.length == 0) return false;
+        if(star != std::string::npos) {
+            uint64_t factor;
+            if(!parse_number(entry.substr(star + 1), factor) || factor < 2) return false;
+            spec.factor = factor;
+        }
+        out.push_back(spec);
+        start = end + 1;
+    }
+    return true;
+}
+
+// expands the given prefix specifications into an ascending list of distinct prefix lengths for a text of length n
+// prefix lengths exceeding the text are truncated, and geometric sequences continue until they reach the end of the text
+std::vector<size_t> expand_prefixes(std::vector<PrefixSpec> const& specs, size_t const n) {
+    std::vector<size_t> prefixes;
+    for(auto const& spec : specs) {
+        size_t m = spec.length;
+        prefixes.push_back(std::min(m, n));
+        while(spec.factor > 1 && m < n) {
+            m = (m > n / spec.factor) ? n : m * spec.factor;
+            prefixes.push_back(std::min(m, n));
+        }
+    }
+    std::sort(prefixes.begin(), prefixes.end());
+    prefixes.erase(std::unique(prefixes.begin(), prefixes.end()), prefixes.end());
+    return prefixes;
+}
+
+// the options given on the command line
+struct Options : MeasureOptions {
+    std::string file;
     size_t prefix = SIZE_MAX;
-    if(argc >= 3) {
-        prefix = std::atoll(argv[2]);
+    OutputFormat format = OutputFormat::TEXT;
+    bool z78_estimate = false; // estimate z78 in parallel rather than computing it exactly
+    bool concurrent = false;
+    int threads = 0; // the number of threads used by parallel algorithms, zero for all available
+    bool semi_external = false;
+    std::vector<PrefixSpec> prefixes;
+    size_t block_size = 0; // zero unless processing the input in blocks
+    size_t block_overlap = 0;
+    bool batch = false;
+    size_t estimate_blocks = 0; // zero unless estimating the measures from a sample of blocks
+    uint64_t estimate_seed = 0;
+    double progress_interval = 0; // the seconds between progress reports, zero unless reporting the progress
+    double time_limit = 0; // the seconds after which the computation is cancelled, zero if unlimited
+    std::string index_cache; // the directory of the persistent index cache, if any
+    std::string rlbwt; // the file to write the run-length encoded BWT to while counting r, if any
+    std::string z77_out; // the file to write the LZ77 factorization to, if any
+    std::string z78_out; // the file to write the LZ78 factorization to, if any
+};
+
+// the output files opened by a computation, which are removed if it is cancelled
+// nb: files are registered by the tasks that open them, which may run concurrently
+struct OutputFiles {
+    std::mutex mutex;
+    std::vector<std::string> paths;
+
+    void add(std::string const& path) {
+        std::lock_guard lock(mutex);
+        paths.push_back(path);
     }
+};
 
-    sdsl::cache_config cc;
+// stores the text in the SDSL's cache for constructing the SA and LCP array, and returns the SDSL's width of the text
+// the SDSL requires the sentinel to be the only zero byte, so if the input contains zero bytes, a copy with the alphabet
+// shifted to free zero is stored instead, which has the same SA and LCP array
+// if all 256 byte values occur, the shifted characters do not fit into a byte, so the copy uses an integer alphabet
+uint8_t store_sdsl_text(sdsl::int_vector<8> const& text, sdsl::cache_config& cc) {
+    auto const n = text.size();
+    auto const* text_data = (uint8_t const*)text.data();
+    if(std::memchr(text_data, 0, n - 1) == nullptr) {
+        sdsl::store_to_cache(text, sdsl::conf::KEY_TEXT, cc);
+        return 8;
+    }
 
-    // load file
-    std::cerr << "loading file ...";
-    std::cerr.flush();
+    uint8_t map[256];
+    if(shifted_alphabet(text_data, n - 1, map)) {
+        std::cerr << " (shifting the alphabet)";
+        sdsl::int_vector<8> shifted(n, 0);
+        for(size_t i = 0; i + 1 < n; i++) shifted[i] = map[text_data[i]];
+        sdsl::store_to_cache(shifted, sdsl::conf::KEY_TEXT, cc);
+        return 8;
+    } else {
+        std::cerr << " (using an integer alphabet)";
+        sdsl::int_vector<> shifted(n, 0, 9);
+        for(size_t i = 0; i + 1 < n; i++) shifted[i] = size_t(text_data[i]) + 1;
+        sdsl::store_to_cache(shifted, sdsl::conf::KEY_TEXT_INT, cc);
+        return 0;
+    }
+}
 
-    sdsl::int_vector<8> text;
-    {
-        std::string s;
-        {
-            std::ifstream ifs(argv[1]);
-            std::istreambuf_iterator<char> it(ifs);
-            std::istreambuf_iterator<char> end;
+// appends the requested measures of a result to the fields of a record in order of output
+// the relative error of an estimated z78 follows it if given
+void append_measures(std::vector<Field>& fields, unsigned const measures, Result const& result, double const* z78_error = nullptr) {
+    if(measures & MEASURE_N) fields.push_back(Field::number("n", result.n));
+    if(measures & MEASURE_SIGMA) fields.push_back(Field::number("sigma", result.sigma));
+    if(measures & MEASURE_H0) fields.push_back(Field::number("h0", result.h0));
+    if(measures & MEASURE_HK) {
+        for(auto const& [k, h] : result.hk) fields.push_back(Field::number("h" + std::to_string(k), h));
+    }
+    if(measures & MEASURE_R) fields.push_back(Field::number("r", result.r));
+    if(measures & MEASURE_Z78) {
+        fields.push_back(Field::number("z78", result.z78));
+        if(z78_error) fields.push_back(Field::number("z78_error", *z78_error));
+    }
+    if(measures & MEASURE_Z77) fields.push_back(Field::number("z77", result.z77));
+    if(measures & MEASURE_DELTA) fields.push_back(Field::number("delta", result.delta, true));
+}
 
-            while(it != end && s.size() < prefix) {
-                s.push_back(*it++);
-            }
-        }
+// runs the given task like std::async, using the given number of threads for parallel algorithms unless it is zero
+// nb: threads started by std::async do not inherit the number of threads set via omp_set_num_threads
+template<typename Task>
+auto async_task(std::launch const policy, int const threads, Task task) {
+    return std::async(policy, [threads, task = std::move(task)]() mutable {
+        if(threads > 0) omp_set_num_threads(threads);
+        return task();
+    });
+}
 
-        text = sdsl::int_vector<8>(s.size());
-        for(size_t i = 0; i < s.size(); i++) {
-            if(s[i] == 0 && i < s.size() - 1) {
-                std::cerr << " failed -- the input file must not contain any zero bytes!" << std::endl;
-                return -2;
+// computes the requested measures for the loaded text and prints the results
+// the SA, and all other arrays of text positions or lengths held in RAM, store entries of the given type
+// the resources used by each phase are recorded in the given log and printed along with the results
+// the output files are registered in the given list once they are opened
+template<typename Index>
+void run(Options const& opts, sdsl::int_vector<8>& text, sdsl::cache_config& cc, OutputFiles& outputs, PhaseLog& phases) {
+    auto const& file = opts.file;
+    auto const measures = opts.measures;
+    auto const semi_external = opts.semi_external;
+    auto const z77_lcp = opts.z77_lcp;
+
+    auto const n = text.size();
+    auto const actual_n = n - 1; // not taking into account the sentinel
+    auto const* text_data = (uint8_t const*)text.data();
+
+    auto const structures = required_structures(measures, z77_lcp);
+
+    // each measure is computed by a task whose result is printed in order of output
+    // unless computing concurrently, the tasks are deferred until their results are printed
+    auto const policy = opts.concurrent ? std::launch::async : std::launch::deferred;
+
+    // the alphabet, H0 entropy and LZ78 do not need the SA, so they are started right away
+    std::future<std::pair<size_t, double>> task_h0;
+    if(measures & (MEASURE_SIGMA | MEASURE_H0)) {
+        task_h0 = async_task(policy, opts.threads, [&](){
+            ProgressPhase phase("h0");
+            auto const t = phases.start();
+            auto const result = alphabet_entropy(text_data, actual_n);
+            phases.stop("h0", t);
+            return result;
+        });
+    }
+
+    std::future<size_t> task_z78;
+    size_t trie_memory = 0;
+    double z78_error = 0;
+    if(measures & MEASURE_Z78) {
+        task_z78 = async_task(policy, opts.threads, [&](){
+            ProgressPhase phase("z78", actual_n);
+            auto const t = phases.start();
+            TrieCache tries;
+            size_t z78;
+            if(opts.z78_estimate) {
+                auto const estimate = lz78_estimate(text_data, actual_n, trie_memory);
+                z78 = estimate.z78;
+                z78_error = estimate.error;
+            } else if(!opts.z78_out.empty()) {
+                LZ78Writer out(opts.z78_out, actual_n);
+                outputs.add(opts.z78_out);
+                size_t final_phrase;
+                z78 = lz78_by_trie(opts.trie, tries, text_data, { actual_n }, trie_memory, out, &final_phrase)[0];
+                if(!out.close(final_phrase)) std::cerr << "cannot write the LZ78 factorization to " << opts.z78_out << std::endl;
+            } else {
+                z78 = lz78_by_trie(opts.trie, tries, text_data, { actual_n }, trie_memory)[0];
             }
-            text[i] = (unsigned char)s[i];
+            phases.stop("z78", t);
+            return z78;
+        });
+    }
+
+    // with a persistent index cache, the SA and LCP information of the input are reused if they were stored by an earlier
+    // run, and stored otherwise
+    // in RAM, they are mapped from the cached files, whereas in semi-external mode, the SDSL's cache files are kept
+    // nb: in semi-external mode, the SDSL constructs the arrays under a temporary id, and they are renamed to the names of
+    // the index cache once complete, so that neither a crashed nor a concurrent run leaves or reads partial arrays
+    std::optional<IndexCache> cache;
+    bool sa_cached = false;
+    bool lcp_cached = false;
+    if(!opts.index_cache.empty()) {
+        cache.emplace(opts.index_cache, text_data, n);
+        if(semi_external) {
+            std::filesystem::create_directories(cache->dir());
+            sdsl::cache_config const complete(false, cache->dir(), cache->id());
+            cc = sdsl::cache_config(false, cache->dir(), cache->id() + ".tmp" + std::to_string(getpid()));
+            cc.file_map[sdsl::conf::KEY_SA] = sdsl::cache_file_name(sdsl::conf::KEY_SA, complete);
+            cc.file_map[sdsl::conf::KEY_LCP] = sdsl::cache_file_name(sdsl::conf::KEY_LCP, complete);
+            sa_cached = sdsl::cache_file_exists(sdsl::conf::KEY_SA, cc);
+            lcp_cached = sdsl::cache_file_exists(sdsl::conf::KEY_LCP, cc);
         }
-        if(text[text.size()-1] != 0) sdsl::append_zero_symbol(text);
     }
-    sdsl::store_to_cache(text, sdsl::conf::KEY_TEXT, cc);
-    std::cerr << std::endl;
 
-    auto const n = text.size();
-    auto const actual_n = n - 1; // not taking into account the sentinel
+    // runs the given SDSL construction of the array of the given key, and renames it to its name in the index cache, if any
+    auto construct_sdsl = [&](sdsl::cache_config& config, std::string const& key, auto construct) {
+        if(!cache) {
+            construct();
+            return;
+        }
+
+        auto const name = config.file_map[key];
+        config.file_map.erase(key);
+        construct();
+        std::error_code ec;
+        std::filesystem::rename(sdsl::cache_file_name(key, config), name, ec);
+        if(!ec) config.file_map[key] = name;
+    };
 
     // construct SA
-    std::cerr << "computing SA ...";
-    std::cerr.flush();
-    sdsl::construct_sa<8>(cc);
+    std::vector<Index> sa_vec;
+    MappedArray<Index> sa_map;
+    std::span<Index const> sa;
+    uint8_t sdsl_width = 8;
+    if(structures & STRUCT_SA) {
+        std::cerr << "computing SA ...";
+        std::cerr.flush();
 
-    // cache SA in RAM
-    sdsl::int_vector_buffer<> sa_buf(sdsl::cache_file_name(sdsl::conf::KEY_SA, cc));
-    sdsl::int_vector<> sa;
-    sa.width(sa_buf.width());
-    sa.resize(n);
-    {
-        for(size_t i = 0; i < n; i++) {
-            sa[i] = sa_buf[i];
+        ProgressPhase phase("sa");
+        auto const t = phases.start();
+        if(semi_external) {
+            bool const need_lcp = (structures & STRUCT_LCP) && !lcp_cached;
+            if(!sa_cached || need_lcp) sdsl_width = store_sdsl_text(text, cc);
+            if(!sa_cached) {
+                construct_sdsl(cc, sdsl::conf::KEY_SA, [&](){
+                    if(sdsl_width == 8) sdsl::construct_sa<8>(cc); else sdsl::construct_sa<0>(cc);
+                });
+            }
+
+            // nb: all measures access the SA sequentially, so it is streamed from disk rather than cached in RAM
+        } else if(cache && cache->load("sa", n, sa_map)) {
+            sa = sa_map.span();
+        } else {
+            construct_sa_in_memory(text_data, n, opts.sa_backend, sa_vec);
+            sa = sa_vec;
+            if(cache) cache->store("sa", sa);
         }
+        phases.stop("sa", t);
+
+        std::cerr << std::endl;
     }
 
-    std::cerr << std::endl;
+    // in RAM, the LCP information is computed by a single fused sweep that also counts the BWT runs and collects the
+    // histogram for delta, so r waits for it if the sweep is done anyway
+    // only the PLCP array is kept, and only if z77 needs it
+    // if the PLCP array is cached or the run-length encoded BWT is written, however, r is counted separately
+    MappedArray<Index> plcp_map;
+    bool const plcp_cached = !semi_external && (structures & STRUCT_LCP) && cache && cache->load("plcp", n, plcp_map);
+    bool const fuse_r = !semi_external && (structures & STRUCT_LCP) && !plcp_cached && opts.rlbwt.empty();
+    size_t fused_r = 0;
+    LCPHistogram lcp_hist;
+
+    // the LCP array is constructed by a task of its own that z77 and delta wait for, which also passes on its cancellation
+    // it is released by whichever of them finishes last
+    // nb: the SDSL constructions register files in the cache configuration, so concurrent tasks work on copies of it
+    std::vector<Index> plcp_vec;
+    std::span<Index const> plcp;
+    auto free_plcp = [&](){
+        plcp = {};
+        std::vector<Index>().swap(plcp_vec);
+        plcp_map.reset();
+    };
+    std::atomic<int> lcp_users = ((z77_lcp && (measures & MEASURE_Z77)) ? 1 : 0) + ((semi_external && (measures & MEASURE_DELTA)) ? 1 : 0)
+        + ((measures & MEASURE_HK) ? 1 : 0);
+    std::shared_future<void> task_lcp;
+    if(structures & STRUCT_LCP) {
+        task_lcp = async_task(policy, opts.threads, [&, cc]() mutable {
+            ProgressPhase phase("lcp", 2 * n);
+            auto const t = phases.start();
+            if(semi_external) {
+                if(!lcp_cached) {
+                    construct_sdsl(cc, sdsl::conf::KEY_LCP, [&](){
+                        if(sdsl_width == 8) sdsl::construct_lcp_PHI<8>(cc); else sdsl::construct_lcp_PHI<0>(cc);
+                    });
+                }
+            } else {
+                if(plcp_cached) {
+                    plcp = plcp_map.span();
+                    if(measures & MEASURE_DELTA) plcp_histogram(plcp, lcp_hist);
+                } else {
+                    construct_plcp_fused(text_data, sa, plcp_vec,
+                        (measures & MEASURE_R) ? &fused_r : nullptr,
+                        (measures & MEASURE_DELTA) ? &lcp_hist : nullptr);
+                    plcp = plcp_vec;
+                    if(cache) cache->store("plcp", plcp);
+                }
+                if(lcp_users == 0) free_plcp();
+            }
+            phases.stop("lcp", t);
+        }).share();
+    }
+    auto release_lcp = [&](){
+        if(--lcp_users == 0) {
+            if(semi_external) {
+                if(!cache) sdsl::remove(sdsl::cache_file_name(sdsl::conf::KEY_LCP, cc));
+            } else {
+                free_plcp();
+            }
+        }
+    };
+
+    std::future<HkResult> task_hk;
+    if(measures & MEASURE_HK) {
+        task_hk = async_task(policy, opts.threads, [&](){
+            task_lcp.get();
+
+            ProgressPhase phase("hk", n);
+            auto const t = phases.start();
+            HkResult hk;
+            if(semi_external) {
+                sdsl::int_vector_buffer<> sa_buf(sdsl::cache_file_name(sdsl::conf::KEY_SA, cc));
+                sdsl::int_vector_buffer<> lcp_buf(sdsl::cache_file_name(sdsl::conf::KEY_LCP, cc));
+                hk = hk_by_order(opts.hk_orders, text_data, sa_buf, lcp_buf);
+            } else {
+                PermutedPLCP lcp { sa, plcp };
+                hk = hk_by_order(opts.hk_orders, text_data, sa, lcp);
+            }
+            release_lcp();
+            phases.stop("hk", t);
+            return hk;
+        });
+    }
+
+    std::future<size_t> task_r;
+    if(measures & MEASURE_R) {
+        task_r = async_task(policy, opts.threads, [&](){
+            if(fuse_r) {
+                task_lcp.get();
+                return fused_r;
+            }
+
+            ProgressPhase phase("r", n);
+            auto const t = phases.start();
+            size_t r;
+            if(!opts.rlbwt.empty()) {
+                BinaryWriter out(opts.rlbwt);
+                outputs.add(opts.rlbwt);
+                if(semi_external) {
+                    sdsl::int_vector_buffer<> sa_buf(sdsl::cache_file_name(sdsl::conf::KEY_SA, cc));
+                    r = write_rlbwt(text_data, sa_buf, out);
+                } else {
+                    r = write_rlbwt(text_data, sa, out);
+                }
+                if(!out.close()) std::cerr << "cannot write the run-length encoded BWT to " << opts.rlbwt << std::endl;
+            } else if(!semi_external) {
+                size_t sentinel_pos;
+                auto const bwt = construct_bwt(text_data, sa, sentinel_pos);
+                r = bwt_runs((uint8_t const*)bwt.data(), n, sentinel_pos);
+            } else {
+                // stream the SA from disk
+                sdsl::int_vector_buffer<> sa_buf(sdsl::cache_file_name(sdsl::conf::KEY_SA, cc));
+                r = bwt_runs_streamed(text_data, sa_buf);
+            }
+            phases.stop("r", t);
+            return r;
+        });
+    }
+
+    std::future<size_t> task_z77;
+    if(measures & MEASURE_Z77) {
+        task_z77 = async_task(policy, opts.threads, [&](){
+            if(z77_lcp) task_lcp.get();
+
+            ProgressPhase phase("z77", 2 * n);
+            auto const t = phases.start();
+            auto factorize = [&](auto&& on_factor){
+                if(semi_external) {
+                    sdsl::int_vector_buffer<> sa_buf(sdsl::cache_file_name(sdsl::conf::KEY_SA, cc));
+                    if(z77_lcp) {
+                        sdsl::int_vector_buffer<> lcp_buf(sdsl::cache_file_name(sdsl::conf::KEY_LCP, cc));
+                        return lz77_lcp<Index>(sa_buf, lcp_buf, { actual_n }, on_factor)[0];
+                    } else {
+                        return lz77_psv<Index>(text_data, sa_buf, { actual_n }, on_factor)[0];
+                    }
+                } else {
+                    if(z77_lcp) {
+                        PermutedPLCP lcp { sa, plcp };
+                        return lz77_lcp<Index>(sa, lcp, { actual_n }, on_factor)[0];
+                    } else {
+                        return lz77_psv<Index>(text_data, sa, { actual_n }, on_factor)[0];
+                    }
+                }
+            };
+
+            size_t z77;
+            if(!opts.z77_out.empty()) {
+                LZ77Writer out(opts.z77_out, text_data, n);
+                outputs.add(opts.z77_out);
+                z77 = factorize(out);
+                if(!out.close()) std::cerr << "cannot write the LZ77 factorization to " << opts.z77_out << std::endl;
+            } else {
+                z77 = factorize(IgnoreFactors());
+            }
+            if(z77_lcp) release_lcp();
+            phases.stop("z77", t);
+            return z77;
+        });
+    }
+
+    std::future<double> task_delta;
+    if(measures & MEASURE_DELTA) {
+        task_delta = async_task(policy, opts.threads, [&](){
+            task_lcp.get();
+
+            ProgressPhase phase("delta", n);
+            auto const t = phases.start();
+            double delta;
+            if(!semi_external) {
+                delta = lcp_hist.substring_complexity(n);
+            } else {
+                sdsl::int_vector_buffer<> lcp_buf(sdsl::cache_file_name(sdsl::conf::KEY_LCP, cc));
+                delta = substring_complexity(lcp_buf, n);
+                release_lcp();
+            }
+            phases.stop("delta", t);
+            return delta;
+        });
+    }
 
     // output
-    std::cout << "RESULT file=" << argv[1];
+    Result result;
+    result.n = actual_n;
+    if(measures & (MEASURE_SIGMA | MEASURE_H0)) std::tie(result.sigma, result.h0) = task_h0.get();
+    if(measures & MEASURE_HK) result.hk = task_hk.get();
+    if(measures & MEASURE_R) result.r = task_r.get();
+    if(measures & MEASURE_Z78) result.z78 = task_z78.get();
+    if(measures & MEASURE_Z77) result.z77 = task_z77.get();
+    if(measures & MEASURE_DELTA) result.delta = task_delta.get();
+
+    std::vector<Field> fields = { Field::string("file", file) };
+    append_measures(fields, measures, result, opts.z78_estimate ? &z78_error : nullptr);
+    phases.each([&](std::string const& key, auto const value){ fields.push_back(Field::number(key, value)); });
+    ResultPrinter(std::cout, opts.format).print(fields);
+
+    if(measures & MEASURE_Z78) {
+        std::cerr << "the LZ78 trie used " << trie_memory << " bytes of RAM" << std::endl;
+    }
+
+    if(semi_external && (structures & STRUCT_SA)) {
+        if(!cache) sdsl::remove(sdsl::cache_file_name(sdsl::conf::KEY_SA, cc));
+        sdsl::remove(sdsl::cache_file_name(sdsl_width == 8 ? sdsl::conf::KEY_TEXT : sdsl::conf::KEY_TEXT_INT, cc));
+    }
+}
+
+// computes the requested measures for each of the given prefixes of the loaded text and prints one result line per prefix
+template<typename Index>
+void run_prefixes(Options const& opts, sdsl::int_vector<8>& text, std::vector<size_t> const& prefixes) {
+    Workspace<Index> ws;
+    size_t trie_memory;
+    auto const results = compute_prefixes<Index>(opts, (uint8_t*)text.data(), text.size(), prefixes, ws, trie_memory, true);
+    ResultPrinter printer(std::cout, opts.format);
+    for(size_t x = 0; x < prefixes.size(); x++) {
+        std::vector<Field> fields = { Field::string("file", opts.file), Field::number("prefix", prefixes[x]) };
+        append_measures(fields, opts.measures, results[x]);
+        printer.print(fields);
+    }
+
+    if(opts.measures & MEASURE_Z78) {
+        std::cerr << "the LZ78 trie used " << trie_memory << " bytes of RAM" << std::endl;
+    }
+}
+
+// splits the input file into blocks of fixed size, which overlap by the given number of bytes, and computes the requested
+// measures for each block independently in RAM, so that only a few blocks are held in RAM at any time
+// the blocks are processed in parallel, and one result line is printed per block in order, followed by an aggregated
+// result line for the whole input: the alphabet and H0 are exact, r, z78 and z77 are summed up, and delta is the
+// maximum, which is a lower bound for the whole input's
+int run_blocks(Options const& opts) {
+    auto const& file = opts.file;
+    auto const measures = opts.measures;
+    auto const block_size = opts.block_size;
+    auto const overlap = opts.block_overlap;
 
-    // n
-    std::cout << " n=" << actual_n; std::cout.flush();
+    int const fd = open(file.c_str(), O_RDONLY);
+    struct stat st;
+    if(fd < 0 || fstat(fd, &st) != 0) {
+        std::cerr << "cannot open the input file!" << std::endl;
+        return -2;
+    }
+
+    size_t file_len = std::min(size_t(st.st_size), opts.prefix);
+    if(file_len > 0) {
+        // a zero byte at the very end of the file is the sentinel, other zero bytes are regular characters
+        // nb: it is stripped before splitting the input, so that no block consists of the sentinel alone
+        char last;
+        if(file_len == size_t(st.st_size) && read_fully(fd, &last, 1, file_len - 1) && last == 0) --file_len;
+    }
+    if(file_len == 0) {
+        close(fd);
+        std::cerr << "the input is empty!" << std::endl;
+        return -2;
+    }
 
-    // alphabet and H0 entropy
-    std::cout << " sigma="; std::cout.flush();
-    size_t sigma = 0;
-    double h0 = 0;
+    size_t const step = block_size - overlap;
+    size_t const num_blocks = file_len <= block_size ? 1 : 1 + (file_len - block_size + step - 1) / step;
+
+    // the histogram of the whole input is obtained from the parts of the blocks that do not overlap their predecessor
+    size_t hist[256];
+    for(size_t c = 0; c < 256; c++) hist[c] = 0;
+
+    Result total;
+    total.n = file_len;
+    bool failed = false;
+    ResultPrinter printer(std::cout, opts.format);
+
+    // the blocks are not cancelled while being processed, but the remaining ones are skipped
+    ProgressPhase phase("blocks", file_len);
+    #pragma omp parallel
     {
-        size_t hist[256];
-        for(size_t c = 0; c < 256; c++) hist[c] = 0;
+        // each thread reuses its buffers for all of its blocks
+        std::vector<uint8_t> text;
+        Workspace<uint32_t> ws;
+
+        #pragma omp for ordered schedule(dynamic, 1)
+        for(size_t b = 0; b < num_blocks; b++) {
+            size_t const offset = b * step;
+            size_t const len = std::min(block_size, file_len - offset);
+            bool const skip = progress_monitor.cancelled();
 
-        for(size_t i = 0; i < actual_n; i++) ++hist[text[i]];
+            text.resize(len + 1);
+            auto* data = (char*)text.data();
+            data[len] = 0;
+            bool const ok = skip || read_fully(fd, data, len, offset);
 
-        for(size_t c = 0; c < 256; c++) {
-            auto const nc = hist[c];
-            if(nc) {
-                ++sigma;
-                h0 += (double(nc) / double(actual_n)) * std::log2(double(actual_n) / double(nc));
+            Result result;
+            size_t block_hist[256];
+            for(size_t c = 0; c < 256; c++) block_hist[c] = 0;
+            if(ok && !skip) {
+                size_t const from = std::min(b > 0 ? overlap : 0, len);
+                byte_histogram(text.data() + from, len - from, block_hist);
+
+                size_t trie_memory;
+                result = compute_prefixes<uint32_t>(opts, text.data(), len + 1, { len }, ws, trie_memory, false)[0];
+            }
+
+            #pragma omp ordered
+            {
+                if(skip) {
+                    // nb: every iteration passes through the ordered region
+                } else if(!ok) {
+                    std::cerr << "block " << b << " at offset " << offset << " cannot be read" << std::endl;
+                    failed = true;
+                } else {
+                    std::vector<Field> fields = { Field::string("file", file), Field::number("block", b), Field::number("offset", offset) };
+                    append_measures(fields, measures, result);
+                    printer.print(fields);
+
+                    for(size_t c = 0; c < 256; c++) hist[c] += block_hist[c];
+                    total.r += result.r;
+                    total.z78 += result.z78;
+                    total.z77 += result.z77;
+                    total.delta = std::max(total.delta, result.delta);
+                }
+                phase.update(offset + len, file_len);
             }
         }
     }
-    std::cout << sigma << " h0=" << h0; std::cout.flush();
+    close(fd);
+    check_cancelled();
+    if(failed) return -2;
 
-    // BWT runs
-    std::cout << " r="; std::cout.flush();
-    size_t r = 0;
-    {
-        auto bwt = [&](size_t const i){
-            auto const j = sa[i];
-            return j > 0 ? text[j-1] : text[n-1];
-        };
-        
-        uint8_t last = bwt(0);
-        for(size_t i = 1; i < n; i++) {
-            auto const c = bwt(i);
-            if(last != 0 && c != last) ++r;
-            last = c;
+    std::tie(total.sigma, total.h0) = histogram_entropy(hist, total.n);
+    std::vector<Field> fields = { Field::string("file", file), Field::number("blocks", num_blocks) };
+    append_measures(fields, measures, total);
+    printer.print(fields);
+    return 0;
+}
+
+// estimates the measures of the input file from a sample of its blocks and a sketch of its substrings, reading each
+// byte only once and holding only a few blocks in RAM
+// the input is tiled into blocks of the block size, and the sample picks one block uniformly at random from each of the
+// given number of strata of consecutive blocks; the measures r, z78 and z77 of the sampled blocks are extrapolated to
+// estimate what block mode would report as their sums over all blocks, along with the half-width of a 95% confidence
+// interval, and the incomplete block at the end of the input is always included exactly
+// the alphabet and H0 are exact, and delta is estimated by sketching the number of distinct substrings of several
+// lengths during a single pass over the input
+int run_estimate(Options const& opts) {
+    auto const& file = opts.file;
+    auto const measures = opts.measures;
+    auto const block_size = opts.block_size;
+
+    int const fd = open(file.c_str(), O_RDONLY);
+    struct stat st;
+    if(fd < 0 || fstat(fd, &st) != 0) {
+        std::cerr << "cannot open the input file!" << std::endl;
+        return -2;
+    }
+
+    size_t file_len = std::min(size_t(st.st_size), opts.prefix);
+    if(file_len > 0) {
+        // a zero byte at the very end of the file is the sentinel
+        char last;
+        if(file_len == size_t(st.st_size) && read_fully(fd, &last, 1, file_len - 1) && last == 0) --file_len;
+    }
+    if(file_len == 0) {
+        close(fd);
+        std::cerr << "the input is empty!" << std::endl;
+        return -2;
+    }
+
+    // pick the sampled blocks, the incomplete block at the end is added last and weighs one
+    size_t const num_full = file_len / block_size;
+    size_t const num_strata = std::min(num_full, opts.estimate_blocks);
+    std::vector<size_t> samples; // block numbers
+    std::vector<size_t> weights; // the number of blocks each sample stands for
+    std::mt19937_64 rng(opts.estimate_seed);
+    for(size_t s = 0; s < num_strata; s++) {
+        size_t const first = s * num_full / num_strata;
+        size_t const end = (s + 1) * num_full / num_strata;
+        samples.push_back(first + std::uniform_int_distribution<size_t>(0, end - first - 1)(rng));
+        weights.push_back(end - first);
+    }
+    if(file_len % block_size) {
+        samples.push_back(num_full);
+        weights.push_back(1);
+    }
+
+    // compute r, z78 and z77 for the sampled blocks in parallel
+    auto block_opts = opts;
+    block_opts.measures = measures & (MEASURE_R | MEASURE_Z78 | MEASURE_Z77);
+    std::vector<Result> results(samples.size());
+    bool failed = false;
+    if(block_opts.measures) {
+        std::cerr << "computing the measures for " << samples.size() << " sampled blocks ..." << std::endl;
+
+        ProgressPhase phase("blocks", samples.size(), "blocks");
+        std::atomic<size_t> finished = 0;
+        #pragma omp parallel
+        {
+            std::vector<uint8_t> text;
+            Workspace<uint32_t> ws;
+
+            #pragma omp for schedule(dynamic, 1)
+            for(size_t x = 0; x < samples.size(); x++) {
+                if(progress_monitor.cancelled()) continue;
+
+                size_t const offset = samples[x] * block_size;
+                size_t const len = std::min(block_size, file_len - offset);
+
+                text.resize(len + 1);
+                text[len] = 0;
+                if(!read_fully(fd, (char*)text.data(), len, offset)) {
+                    #pragma omp atomic write
+                    failed = true;
+                    continue;
+                }
+
+                size_t trie_memory;
+                results[x] = compute_prefixes<uint32_t>(block_opts, text.data(), len + 1, { len }, ws, trie_memory, false)[0];
+                phase.update(++finished, samples.size());
+            }
         }
     }
-    std::cout << r; std::cout.flush();
-    
-    // LZ78
-    std::cout << " z78="; std::cout.flush();
-    size_t z78 = 0;
-    {
-        Trie trie;
-
-        auto v = trie.root();
-        for(size_t i = 0; i < actual_n; i++) {
-            auto const c = text[i];
-            if(!trie.try_get_child(v, c, v)) {
-                trie.insert_child(v, c);
-                v = trie.root();
-                ++z78;
+
+    // stream the whole input for the histogram and the substring sketch, each thread sketching part of each chunk
+    // nb: the sketch lengths are spread geometrically, because delta is usually attained for short substrings
+    size_t hist[256];
+    for(size_t c = 0; c < 256; c++) hist[c] = 0;
+    double delta = 0, delta_error = 0;
+    if(!failed && (measures & (MEASURE_SIGMA | MEASURE_H0 | MEASURE_DELTA))) {
+        std::cerr << "sketching the input ..." << std::endl;
+
+        static constexpr size_t CHUNK_SIZE = size_t(1) << 26;
+        bool const sketch = measures & MEASURE_DELTA;
+        std::vector<size_t> const ks = { 1, 2, 3, 4, 5, 6, 7, 8, 12, 16, 24, 32, 48, 64 };
+        size_t const num_threads = omp_get_max_threads();
+        std::vector<KmerSketch> sketches(sketch ? num_threads : 0, KmerSketch(ks));
+        size_t const history = ks.back() - 1;
+
+        ProgressPhase phase("sketch", file_len);
+        std::vector<uint8_t> buffer(history + CHUNK_SIZE);
+        size_t kept = 0; // the number of characters preceding the chunk in the buffer
+        for(size_t offset = 0; offset < file_len; offset += CHUNK_SIZE) {
+            phase.update(offset, file_len);
+            if(progress_monitor.cancelled()) break;
+
+            size_t const len = std::min(CHUNK_SIZE, file_len - offset);
+            if(!read_fully(fd, (char*)buffer.data() + kept, len, offset)) {
+                failed = true;
+                break;
             }
+            byte_histogram(buffer.data() + kept, len, hist);
+
+            if(sketch) {
+                size_t const part = (len + num_threads - 1) / num_threads;
+                #pragma omp parallel for schedule(static, 1)
+                for(size_t t = 0; t < num_threads; t++) {
+                    size_t const begin = kept + std::min(len, t * part);
+                    size_t const end = kept + std::min(len, (t + 1) * part);
+                    size_t const h = std::min(begin, history);
+                    if(begin < end) sketches[t].add(buffer.data() + begin - h, end - begin + h, h);
+                }
+            }
+
+            // keep the end of the chunk as the history of the next one
+            size_t const next_kept = std::min(history, kept + len);
+            std::memmove(buffer.data(), buffer.data() + kept + len - next_kept, next_kept);
+            kept = next_kept;
         }
-        if(v != trie.root()) ++z78; // final phrase
+
+        if(sketch) {
+            for(size_t t = 1; t < num_threads; t++) sketches[0].merge(sketches[t]);
+            delta = sketches[0].delta(delta_error);
+        }
+    }
+    close(fd);
+    check_cancelled();
+    if(failed) {
+        std::cerr << "cannot read the input file!" << std::endl;
+        return -2;
     }
-    std::cout << z78;
 
-    // LZ77
-    std::cout << " z77="; std::cout.flush();
-    size_t z77 = 0;
-    {
-        sdsl::construct_isa(cc);
-        sdsl::int_vector_buffer<> isa(sdsl::cache_file_name(sdsl::conf::KEY_ISA, cc));
-        
-        for(size_t i = 0; i < actual_n;) {
-            size_t const cur_pos = isa[i];
-
-            // compute PSV and NSV
-            auto lce = [&](size_t const i, size_t const j) {
-                size_t l = 0;
-                while(i + l < actual_n && j + l < actual_n && text[i + l] == text[j + l]) ++l;
-
-                return l;
-            };
+    // extrapolates a measure from the samples, reporting the estimate and the half-width of its confidence interval
+    // the variance is that of simple random sampling with the finite population correction, which does not account for
+    // the stratification and thus tends to overestimate it
+    auto extrapolate = [&](auto const get){
+        double estimate = 0;
+        for(size_t x = 0; x < samples.size(); x++) estimate += double(weights[x]) * double(get(results[x]));
+        if(num_strata < 2 || num_strata == num_full) return std::pair(estimate, 0.0);
 
-            ssize_t psv_pos = (ssize_t)cur_pos - 1;
-            while (psv_pos >= 0 && sa[psv_pos] > i) --psv_pos;
-            size_t const psv_lcp = psv_pos >= 0 ? lce(i, sa[psv_pos]) : 0;
+        double mean = 0;
+        for(size_t x = 0; x < num_strata; x++) mean += double(get(results[x]));
+        mean /= double(num_strata);
+        double var = 0;
+        for(size_t x = 0; x < num_strata; x++) var += (double(get(results[x])) - mean) * (double(get(results[x])) - mean);
+        var /= double(num_strata - 1);
 
-            size_t nsv_pos = cur_pos + 1;
-            while(nsv_pos < actual_n && sa[nsv_pos] > i) ++nsv_pos;
-            size_t const nsv_lcp = nsv_pos < actual_n ? lce(i, sa[nsv_pos]) : 0;
+        double const fpc = 1.0 - double(num_strata) / double(num_full);
+        return std::pair(estimate, 1.96 * double(num_full) * std::sqrt(var / double(num_strata) * fpc));
+    };
+
+    std::vector<Field> fields = { Field::string("file", file), Field::number("estimate", num_strata), Field::number("block", block_size) };
+    if(measures & MEASURE_N) fields.push_back(Field::number("n", file_len));
+    auto const [sigma, h0] = histogram_entropy(hist, file_len);
+    if(measures & MEASURE_SIGMA) fields.push_back(Field::number("sigma", sigma));
+    if(measures & MEASURE_H0) fields.push_back(Field::number("h0", h0));
+    auto append_estimate = [&](std::string const& name, auto const get){
+        auto const [estimate, ci] = extrapolate(get);
+        fields.push_back(Field::number(name, size_t(std::llround(estimate))));
+        fields.push_back(Field::number(name + "_ci", size_t(std::llround(ci))));
+    };
+    if(measures & MEASURE_R) append_estimate("r", [](Result const& r){ return r.r; });
+    if(measures & MEASURE_Z78) append_estimate("z78", [](Result const& r){ return r.z78; });
+    if(measures & MEASURE_Z77) append_estimate("z77", [](Result const& r){ return r.z77; });
+    if(measures & MEASURE_DELTA) {
+        fields.push_back(Field::number("delta", delta, true));
+        fields.push_back(Field::number("delta_ci", 1.96 * delta_error * delta, true));
+    }
+    ResultPrinter(std::cout, opts.format).print(fields);
+    return 0;
+}
 
-            // select maximum and advance
-            auto const max_lcp = std::max(psv_lcp, nsv_lcp); // nb: may be zero
-            auto const factor_len = std::max(size_t(1), max_lcp);
-            i += factor_len;
-            ++z77;
+// computes the requested measures for each of many input files, given as a directory or a list with one path per line
+// the files are processed in parallel, and one result line is printed per file in order
+// each thread reuses its buffers and data structures for all of its files, so that they need not be reallocated
+int run_batch(Options const& opts) {
+    std::vector<std::string> files;
+    std::error_code ec;
+    if(std::filesystem::is_directory(opts.file, ec)) {
+        for(auto const& entry : std::filesystem::directory_iterator(opts.file, ec)) {
+            if(entry.is_regular_file()) files.push_back(entry.path().string());
+        }
+        std::sort(files.begin(), files.end());
+    } else {
+        std::ifstream list(opts.file);
+        if(!list) {
+            std::cerr << "cannot open the list of input files!" << std::endl;
+            return -2;
+        }
+        for(std::string line; std::getline(list, line);) {
+            if(!line.empty()) files.push_back(line);
         }
-        sdsl::remove(sdsl::cache_file_name(sdsl::conf::KEY_ISA, cc));
     }
-    std::cout << z77; std::cout.flush();
 
-    // delta -- courtesy of regindex/substring-complexity (MIT license)
-    std::cout << " delta="; std::cout.flush();
-    double delta = 0;
+    bool failed = false;
+    ResultPrinter printer(std::cout, opts.format);
+
+    // the files are not cancelled while being processed, but the remaining ones are skipped
+    ProgressPhase phase("files", files.size(), "files");
+    #pragma omp parallel
     {
-        sdsl::construct_lcp_PHI<8>(cc);
-        sdsl::int_vector_buffer<> lcp(sdsl::cache_file_name(sdsl::conf::KEY_LCP, cc));
+        std::vector<uint8_t> text;
+        Workspace<uint32_t> ws;
+
+        #pragma omp for ordered schedule(dynamic, 1)
+        for(size_t f = 0; f < files.size(); f++) {
+            bool const skip = progress_monitor.cancelled();
+            char const* error = nullptr;
+            if(!skip) error = load_text(files[f], opts.prefix, text);
+
+            // nb: the loaded text is terminated by the sentinel, so it is used in place
+            Result result;
+            if(!skip && !error) error = compute(text, Termination::SENTINEL, opts, result, ws);
+
+            #pragma omp ordered
+            {
+                phase.update(f + 1, files.size());
+                if(skip) {
+                    // nb: every iteration passes through the ordered region
+                } else if(error) {
+                    std::cerr << files[f] << ": " << error << std::endl;
+                    failed = true;
+                } else {
+                    std::vector<Field> fields = { Field::string("file", files[f]) };
+                    append_measures(fields, opts.measures, result);
+                    printer.print(fields);
+                }
+            }
+        }
+    }
+    check_cancelled();
+    return failed ? -2 : 0;
+}
+
+// formats a duration given in seconds, e.g., 1h02m03s
+std::string format_duration(double const seconds) {
+    auto const t = size_t(std::max(0.0, seconds));
+    char buf[32];
+    if(t >= 3600) {
+        std::snprintf(buf, sizeof(buf), "%zuh%02zum%02zus", t / 3600, (t / 60) % 60, t % 60);
+    } else if(t >= 60) {
+        std::snprintf(buf, sizeof(buf), "%zum%02zus", t / 60, t % 60);
+    } else {
+        std::snprintf(buf, sizeof(buf), "%zus", t);
+    }
+    return buf;
+}
 
-        std::vector<uint32_t> dk(n, 0);
-        for(size_t i = 1; i < n; i++) {
-            dk[lcp[i]+1]++;
+// prints the progress of the running phases, along with their throughput and the estimated time remaining
+void print_progress(std::vector<ProgressReport> const& reports) {
+    for(auto const& p : reports) {
+        std::cerr << "progress: " << p.phase;
+        double const rate = p.elapsed > 0 ? double(p.done) / p.elapsed : 0;
+        if(p.total > 0) {
+            std::cerr << " " << std::fixed << std::setprecision(1) << 100.0 * double(p.done) / double(p.total) << "%";
+            if(p.unit) {
+                std::cerr << " (" << p.done << "/" << p.total << " " << p.unit << ", " << rate << " " << p.unit << "/s";
+            } else {
+                std::cerr << " (" << rate / 1e6 << " MB/s";
+            }
+            std::cerr << std::defaultfloat << std::setprecision(6);
+            if(rate > 0 && p.done < p.total) std::cerr << ", ETA " << format_duration(double(p.total - p.done) / rate);
+            std::cerr << ")";
+        } else {
+            std::cerr << " running for " << format_duration(p.elapsed);
         }
+        std::cerr << std::endl;
+    }
+}
 
-        double x = dk[1];
-        delta = x;
-        for(size_t k = 2; k < n; k++) {
-            x = x + dk[k] - 1;
-            delta = std::max(delta, x / k);
+// cancels the computation on the first signal, and lets the next one terminate the process
+void cancel_on_signal(int const sig) {
+    progress_monitor.cancel();
+    std::signal(sig, SIG_DFL);
+}
+
+// removes the temporary files of a cancelled computation for a single input, as well as the incomplete output files that
+// it opened
+// nb: outputs that are not regular files, e.g., pipes or devices, are left alone, and so is the persistent index cache,
+// whose arrays are only renamed into place once complete
+void remove_temporary_files(Options const& opts, sdsl::cache_config const& cc, OutputFiles& outputs) {
+    if(opts.semi_external) {
+        sdsl::remove(sdsl::cache_file_name(sdsl::conf::KEY_TEXT, cc));
+        sdsl::remove(sdsl::cache_file_name(sdsl::conf::KEY_TEXT_INT, cc));
+        if(opts.index_cache.empty()) {
+            sdsl::remove(sdsl::cache_file_name(sdsl::conf::KEY_SA, cc));
+            sdsl::remove(sdsl::cache_file_name(sdsl::conf::KEY_LCP, cc));
         }
-        sdsl::remove(sdsl::cache_file_name(sdsl::conf::KEY_LCP, cc));
     }
-    std::cout << std::fixed << delta; std::cout.flush();
-    std::cout << std::endl;
+    std::lock_guard lock(outputs.mutex);
+    for(auto const& path : outputs.paths) {
+        std::error_code ec;
+        if(std::filesystem::is_regular_file(std::filesystem::symlink_status(path, ec))) std::filesystem::remove(path, ec);
+    }
+}
 
-    sdsl::remove(sdsl::cache_file_name(sdsl::conf::KEY_SA, cc));
-    sdsl::remove(sdsl::cache_file_name(sdsl::conf::KEY_TEXT, cc));
+// validates the combination of options and computes the measures in the requested mode
+// the temporary files of the SDSL are registered in the given cache configuration, and the output files in the given list
+int dispatch(Options& opts, sdsl::cache_config& cc, OutputFiles& outputs) {
+    auto const& file = opts.file;
+
+    if(!opts.prefixes.empty() && opts.semi_external) {
+        std::cerr << "--prefixes cannot be combined with --semi-external" << std::endl;
+        return -1;
+    }
 
+    if(opts.z78_estimate && (!opts.z78_out.empty() || !opts.prefixes.empty() || opts.batch || opts.block_size > 0)) {
+        std::cerr << "--z78=estimate cannot be combined with --z78-out, --prefixes, --block or --batch" << std::endl;
+        return -1;
+    }
+
+    // the persistent index cache and the concurrent tasks only apply to computing the measures for the whole input at once
+    bool const whole_input = opts.prefixes.empty() && opts.block_size == 0 && !opts.batch && opts.estimate_blocks == 0;
+    if((!opts.index_cache.empty() || opts.concurrent) && !whole_input) {
+        std::cerr << "--index-cache and --concurrent cannot be combined with --prefixes, --block, --batch or --estimate" << std::endl;
+        return -1;
+    }
+
+    bool const writes_files = !opts.rlbwt.empty() || !opts.z77_out.empty() || !opts.z78_out.empty();
+    if(writes_files && (!opts.prefixes.empty() || opts.batch || opts.block_size > 0)) {
+        std::cerr << "--rlbwt, --z77-out and --z78-out cannot be combined with --prefixes, --block or --batch" << std::endl;
+        return -1;
+    }
+
+    if(opts.estimate_blocks > 0) {
+        if(!opts.prefixes.empty() || opts.semi_external || opts.batch || opts.block_overlap > 0 || writes_files || opts.z78_estimate) {
+            std::cerr << "--estimate cannot be combined with --prefixes, --semi-external, --batch, --overlap, --z78=estimate or any output files" << std::endl;
+            return -1;
+        }
+        if(opts.block_size == 0) opts.block_size = size_t(1) << 20;
+        return run_estimate(opts);
+    }
+
+    if(opts.batch) {
+        if(!opts.prefixes.empty() || opts.semi_external || opts.block_size > 0) {
+            std::cerr << "--batch cannot be combined with --prefixes, --block or --semi-external" << std::endl;
+            return -1;
+        }
+        return run_batch(opts);
+    }
+
+    if(opts.block_size > 0) {
+        if(opts.block_overlap >= opts.block_size) {
+            std::cerr << "the block overlap must be smaller than the block size" << std::endl;
+            return -1;
+        }
+        if(!opts.prefixes.empty() || opts.semi_external) {
+            std::cerr << "--block cannot be combined with --prefixes or --semi-external" << std::endl;
+            return -1;
+        }
+        return run_blocks(opts);
+    }
+
+    // only the longest requested prefix needs to be loaded
+    auto max_len = opts.prefix;
+    if(!opts.prefixes.empty()) {
+        size_t max_prefix = 0;
+        for(auto const& spec : opts.prefixes) max_prefix = std::max(max_prefix, spec.factor > 1 ? SIZE_MAX : spec.length);
+        max_len = std::min(max_len, max_prefix);
+    }
+
+    // load file
+    std::cerr << "loading file ...";
+    std::cerr.flush();
+
+    PhaseLog phases;
+    auto const t_load = phases.start();
+
+    sdsl::int_vector<8> text;
+    {
+        ProgressPhase phase("load");
+        if(auto const error = load_text(file, max_len, text)) {
+            std::cerr << " failed -- " << error << "!" << std::endl;
+            return -2;
+        }
+    }
+    phases.stop("load", t_load);
+    std::cerr << std::endl;
+    check_cancelled();
+
+    // select the integer type for SA entries
+    auto const n = text.size();
+    auto const prefixes = expand_prefixes(opts.prefixes, n - 1);
+    if(n <= UINT32_MAX) {
+        if(prefixes.empty()) run<uint32_t>(opts, text, cc, outputs, phases); else run_prefixes<uint32_t>(opts, text, prefixes);
+    } else if(n <= uint40_t::MAX) {
+        if(prefixes.empty()) run<uint40_t>(opts, text, cc, outputs, phases); else run_prefixes<uint40_t>(opts, text, prefixes);
+    } else {
+        std::cerr << "the input is too large" << std::endl;
+        return -2;
+    }
     return 0;
 }
+
+int main(int argc, char** argv) {
+    // parse arguments
+    Options opts;
+    bool hk_given = false;
+    std::vector<std::string> args;
+    for(int i = 1; i < argc; i++) {
+        std::string const arg = argv[i];
+        if(arg == "--z77=lcp") {
+            opts.z77_lcp = true;
+        } else if(arg == "--z77=psv") {
+            opts.z77_lcp = false;
+        } else if(arg == "--semi-external") {
+            opts.semi_external = true;
+        } else if(arg == "--trie=list" || arg == "--trie=hash" || arg == "--trie=hybrid") {
+            opts.trie = arg.substr(7);
+        } else if(arg == "--z78=exact") {
+            opts.z78_estimate = false;
+        } else if(arg == "--z78=estimate") {
+            opts.z78_estimate = true;
+        } else if(arg == "--format=text") {
+            opts.format = OutputFormat::TEXT;
+        } else if(arg == "--format=json") {
+            opts.format = OutputFormat::JSON;
+        } else if(arg == "--format=csv") {
+            opts.format = OutputFormat::CSV;
+        } else if(arg == "--concurrent") {
+            opts.concurrent = true;
+        } else if(arg == "--sa=divsufsort") {
+            opts.sa_backend = SABackend::DIVSUFSORT;
+        } else if(arg == "--sa=parallel") {
+            opts.sa_backend = SABackend::PARALLEL;
+        } else if(arg.starts_with("--threads=")) {
+            auto const threads = std::atoi(arg.substr(10).c_str());
+            if(threads <= 0) {
+                std::cerr << "invalid number of threads: " << arg.substr(10) << std::endl;
+                return -1;
+            }
+            opts.threads = threads;
+            omp_set_num_threads(threads);
+        } else if(arg.starts_with("--measures=")) {
+            if(!parse_measures(arg.substr(11), opts.measures)) {
+                std::cerr << "invalid list of measures: " << arg.substr(11) << std::endl;
+                return -1;
+            }
+        } else if(arg.starts_with("--hk=")) {
+            if(!parse_orders(arg.substr(5), opts.hk_orders)) {
+                std::cerr << "invalid list of orders: " << arg.substr(5) << std::endl;
+                return -1;
+            }
+            hk_given = true;
+        } else if(arg.starts_with("--prefixes=")) {
+            if(!parse_prefixes(arg.substr(11), opts.prefixes)) {
+                std::cerr << "invalid list of prefixes: " << arg.substr(11) << std::endl;
+                return -1;
+            }
+        } else if(arg.starts_with("--index-cache=")) {
+            opts.index_cache = arg.substr(14);
+        } else if(arg.starts_with("--rlbwt=")) {
+            opts.rlbwt = arg.substr(8);
+        } else if(arg.starts_with("--z77-out=")) {
+            opts.z77_out = arg.substr(10);
+        } else if(arg.starts_with("--z78-out=")) {
+            opts.z78_out = arg.substr(10);
+        } else if(arg == "--estimate") {
+            opts.estimate_blocks = 16;
+        } else if(arg.starts_with("--estimate=")) {
+            auto const blocks = std::atoll(arg.substr(11).c_str());
+            if(blocks <= 0) {
+                std::cerr << "invalid number of sampled blocks: " << arg.substr(11) << std::endl;
+                return -1;
+            }
+            opts.estimate_blocks = blocks;
+        } else if(arg.starts_with("--seed=")) {
+            if(!parse_number(arg.substr(7), opts.estimate_seed)) {
+                std::cerr << "invalid seed: " << arg.substr(7) << std::endl;
+                return -1;
+            }
+        } else if(arg == "--progress") {
+            opts.progress_interval = 10;
+        } else if(arg.starts_with("--progress=")) {
+            opts.progress_interval = std::atof(arg.substr(11).c_str());
+            if(opts.progress_interval <= 0) {
+                std::cerr << "invalid progress interval: " << arg.substr(11) << std::endl;
+                return -1;
+            }
+        } else if(arg.starts_with("--time-limit=")) {
+            opts.time_limit = std::atof(arg.substr(13).c_str());
+            if(opts.time_limit <= 0) {
+                std::cerr << "invalid time limit: " << arg.substr(13) << std::endl;
+                return -1;
+            }
+        } else if(arg == "--batch") {
+            opts.batch = true;
+        } else if(arg.starts_with("--block=")) {
+            if(!parse_length(arg.substr(8), opts.block_size) || opts.block_size == 0 || opts.block_size >= UINT32_MAX) {
+                std::cerr << "invalid block size: " << arg.substr(8) << std::endl;
+                return -1;
+            }
+        } else if(arg.starts_with("--overlap=")) {
+            if(!parse_length(arg.substr(10), opts.block_overlap)) {
+                std::cerr << "invalid block overlap: " << arg.substr(10) << std::endl;
+                return -1;
+            }
+        } else if(arg.starts_with("--")) {
+            std::cerr << "unknown option: " << arg << std::endl;
+            return -1;
+        } else {
+            args.push_back(arg);
+        }
+    }
+    if(hk_given) opts.measures |= MEASURE_HK;
+    if(!opts.rlbwt.empty()) opts.measures |= MEASURE_R;
+    if(!opts.z77_out.empty()) opts.measures |= MEASURE_Z77;
+    if(!opts.z78_out.empty()) opts.measures |= MEASURE_Z78;
+
+    if(args.empty()) {
+        std::cerr << "usage: " << argv[0] << " [options] <FILE> [prefix]" << std::endl;
+        std::cerr << std::endl;
+        std::cerr << "options:" << std::endl;
+        std::cerr << "  --measures=LIST   comma-separated list of measures to compute (default: n,sigma,h0,r,z78,z77,delta)" << std::endl;
+        std::cerr << "  --hk=LIST         also compute H_k for each of the comma-separated orders k (default of measure hk: 1,2,3,4)" << std::endl;
+        std::cerr << "  --sa=BACKEND      the backend for constructing the SA in RAM: divsufsort (default) or parallel" << std::endl;
+        std::cerr << "  --threads=NUM     the number of threads used by parallel algorithms (default: all available)" << std::endl;
+        std::cerr << "  --trie=TRIE       the LZ78 trie implementation: list (default), hash or hybrid" << std::endl;
+        std::cerr << "  --z78=MODE        compute z78 exactly (default) or estimate it in parallel (estimate), which depends on --threads" << std::endl;
+        std::cerr << "  --format=FORMAT   print the results as text lines (default), JSON lines (json) or CSV (csv)" << std::endl;
+        std::cerr << "  --concurrent      compute independent measures concurrently" << std::endl;
+        std::cerr << "  --semi-external   construct the SA and LCP array using SDSL's semi-external algorithms" << std::endl;
+        std::cerr << "  --z77=lcp|psv     obtain the LZ77 factor lengths from the LCP array (default) or by comparing characters" << std::endl;
+        std::cerr << "  --prefixes=LIST   comma-separated list of prefix lengths to compute the measures for, e.g., 1M,10M or 1M*2" << std::endl;
+        std::cerr << "  --block=SIZE      compute the measures for each block of the given size independently, e.g., 64M" << std::endl;
+        std::cerr << "  --overlap=SIZE    the number of bytes by which consecutive blocks overlap (default: 0)" << std::endl;
+        std::cerr << "  --estimate[=NUM]  estimate the measures from a sample of NUM blocks (default: 16) of the block size (default: 1M)" << std::endl;
+        std::cerr << "  --seed=NUM        the seed for picking the sampled blocks (default: 0)" << std::endl;
+        std::cerr << "  --batch           FILE is a directory or a list of input files, each of which is processed" << std::endl;
+        std::cerr << "  --rlbwt=FILE      write the run-length encoded BWT with the SA samples at run boundaries while counting r" << std::endl;
+        std::cerr << "  --z77-out=FILE    write the LZ77 factorization (length and distance of each factor) while counting z77" << std::endl;
+        std::cerr << "  --z78-out=FILE    write the LZ78 factorization (parent phrase and character of each phrase) while counting z78" << std::endl;
+        std::cerr << "  --progress[=SEC]  print the progress of the running phases every SEC seconds (default: 10)" << std::endl;
+        std::cerr << "  --time-limit=SEC  cancel the computation after SEC seconds" << std::endl;
+        std::cerr << "  --index-cache=DIR reuse the SA and LCP information stored in the given directory by earlier runs" << std::endl;
+        return -1;
+    }
+
+    opts.file = args[0];
+    if(args.size() >= 2) {
+        opts.prefix = std::atoll(args[1].c_str());
+    }
+
+    // the computation is cancelled by the first interrupt or termination signal, or once the time limit has passed, and
+    // stops at the next progress update
+    std::signal(SIGINT, cancel_on_signal);
+    std::signal(SIGTERM, cancel_on_signal);
+
+    std::optional<ProgressReporter> reporter;
+    if(opts.progress_interval > 0 || opts.time_limit > 0) {
+        auto const seconds = [](double const s){ return std::chrono::milliseconds(size_t(s * 1000)); };
+        reporter.emplace(seconds(opts.progress_interval > 0 ? opts.progress_interval : opts.time_limit),
+            opts.progress_interval > 0 ? ProgressReporter::Callback(print_progress) : ProgressReporter::Callback(),
+            seconds(opts.time_limit));
+    }
+
+    sdsl::cache_config cc;
+    OutputFiles outputs;
+    try {
+        return dispatch(opts, cc, outputs);
+    } catch(Cancelled const&) {
+        remove_temporary_files(opts, cc, outputs);
+        std::cerr << "the computation was cancelled" << std::endl;
+        return -3;
+    }
+}
@@ -0,0 +1,147 @@
+/**
+ * MIT License
+ * 
+ * Copyright (c) Patrick Dinklage
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <iomanip>
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace repetitiveness {
+
+// a named value of a result record, formatted for output
+struct Field {
+    std::string name;
+    std::string value;
+    bool text = false; // whether the value is a string rather than a number
+
+    // formats a number the way the stream would by default, or with a fixed number of decimals if requested
+    template<typename T>
+    static Field number(std::string name, T const value, bool const fixed = false) {
+        std::ostringstream s;
+        if(fixed) s << std::fixed;
+        s << value;
+        return Field { std::move(name), s.str(), false };
+    }
+
+    static Field string(std::string name, std::string value) {
+        return Field { std::move(name), std::move(value), true };
+    }
+};
+
+// the formats in which result records can be printed
+enum class OutputFormat {
+    TEXT, // one line per record starting with RESULT, followed by space-separated key=value pairs
+    JSON, // one JSON object per line (JSON Lines)
+    CSV,  // comma-separated values, with a header line whenever the fields differ from those of the previous record
+};
+
+// prints result records in the given format, one record at a time
+class ResultPrinter {
+public:
+    ResultPrinter(std::ostream& out, OutputFormat const format) : out_(out), format_(format) {
+    }
+
+    void print(std::vector<Field> const& fields) {
+        switch(format_) {
+            case OutputFormat::TEXT:
+                out_ << "RESULT";
+                for(auto const& f : fields) out_ << " " << f.name << "=" << f.value;
+                break;
+
+            case OutputFormat::JSON:
+                out_ << "{";
+                for(size_t i = 0; i < fields.size(); i++) {
+                    if(i > 0) out_ << ",";
+                    out_ << json_string(fields[i].name) << ":";
+                    if(fields[i].text) out_ << json_string(fields[i].value); else out_ << json_number(fields[i].value);
+                }
+                out_ << "}";
+                break;
+
+            case OutputFormat::CSV: {
+                std::vector<std::string> names;
+                for(auto const& f : fields) names.push_back(f.name);
+                if(names != header_) {
+                    for(size_t i = 0; i < names.size(); i++) out_ << (i > 0 ? "," : "") << csv_string(names[i]);
+                    out_ << std::endl;
+                    header_ = std::move(names);
+                }
+                for(size_t i = 0; i < fields.size(); i++) out_ << (i > 0 ? "," : "") << csv_string(fields[i].value);
+                break;
+            }
+        }
+        out_ << std::endl;
+    }
+
+private:
+    static std::string json_string(std::string const& s) {
+        std::ostringstream out;
+        out << '"';
+        for(char const c : s) {
+            switch(c) {
+                case '"': out << "\\\""; break;
+                case '\\': out << "\\\\"; break;
+                case '\n': out << "\\n"; break;
+                case '\r': out << "\\r"; break;
+                case '\t': out << "\\t"; break;
+                default:
+                    if((unsigned char)c < 0x20) {
+                        out << "\\u" << std::hex << std::setw(4) << std::setfill('0') << int(c) << std::dec;
+                    } else {
+                        out << c;
+                    }
+            }
+        }
+        out << '"';
+        return out.str();
+    }
+
+    // nb: JSON has no representation of infinity or NaN
+    static std::string json_number(std::string const& s) {
+        if(s.find_first_of("ni") != std::string::npos) return "null";
+        return s;
+    }
+
+    static std::string csv_string(std::string const& s) {
+        if(s.find_first_of(",\"\r\n") == std::string::npos) return s;
+
+        std::string out = "\"";
+        for(char const c : s) {
+            if(c == '"') out += '"';
+            out += c;
+        }
+        return out + "\"";
+    }
+
+    std::ostream& out_;
+    OutputFormat format_;
+    std::vector<std::string> header_; // the field names of the last CSV header
+};
+
+}
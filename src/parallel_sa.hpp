@@ -0,0 +1,126 @@
+/**
+ * MIT License
+ * 
+ * Copyright (c) Patrick Dinklage
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <parallel/algorithm>
+#include <omp.h>
+
+#include "progress.hpp"
+
+namespace repetitiveness {
+
+// constructs the suffix array using prefix doubling, parallelized using OpenMP
+// the text must be terminated by a sentinel zero byte, but it may contain other zero bytes
+// sa must provide room for n entries of type Index
+//
+// suffixes are first sorted by their first eight characters, then groups of suffixes sharing a common prefix of length h
+// are refined by the rank of the suffixes starting h positions later, doubling h in every round
+// the rank of a suffix is the last SA position of its group (Larsson and Sadakane), and only unsorted groups are processed
+template<typename Index>
+void construct_sa_parallel(uint8_t const* text, size_t const n, Index* sa) {
+    struct Entry {
+        uint64_t key;
+        Index suffix;
+    };
+
+    struct Group {
+        size_t start;
+        size_t end; // exclusive
+    };
+
+    // groups larger than this are sorted by all threads, smaller groups are distributed among the threads
+    static constexpr size_t LARGE_GROUP = size_t(1) << 16;
+
+    // initially, sort by the first seven characters, each incremented by one and packed into nine bits of a word
+    // nb: the sentinel and the positions beyond the end of the text are zero, which is smaller than any character including
+    //     zero bytes, so all suffixes of length at most seven are unique
+    std::vector<Entry> work(n);
+    #pragma omp parallel for
+    for(size_t i = 0; i < n; i++) {
+        uint64_t key = 0;
+        for(size_t k = 0; k < 7; k++) key = (key << 9) | (i + k + 1 < n ? uint64_t(text[i + k]) + 1 : 0);
+        work[i] = Entry{key, Index(i)};
+    }
+
+    std::vector<Index> rank(n);
+    std::vector<Group> groups = {{0, n}};
+    size_t h = 7;
+    while(!groups.empty()) {
+        // sort the entries of each unsorted group by their keys
+        auto by_key = [](Entry const& a, Entry const& b){ return a.key < b.key; };
+        for(auto const& g : groups) {
+            if(g.end - g.start >= LARGE_GROUP) __gnu_parallel::sort(work.begin() + g.start, work.begin() + g.end, by_key);
+        }
+        #pragma omp parallel for schedule(dynamic, 64)
+        for(size_t j = 0; j < groups.size(); j++) {
+            auto const& g = groups[j];
+            if(g.end - g.start < LARGE_GROUP) std::sort(work.begin() + g.start, work.begin() + g.end, by_key);
+        }
+
+        // write back the sorted groups, split them by key and update the ranks
+        std::vector<Group> next_groups;
+        #pragma omp parallel
+        {
+            std::vector<Group> local_groups;
+
+            #pragma omp for schedule(dynamic, 64)
+            for(size_t j = 0; j < groups.size(); j++) {
+                auto const& g = groups[j];
+                size_t end = g.end;
+                for(size_t p = g.end; p > g.start; p--) {
+                    sa[p - 1] = work[p - 1].suffix;
+                    rank[work[p - 1].suffix] = Index(end - 1);
+                    if(p - 1 == g.start || work[p - 2].key != work[p - 1].key) {
+                        if(end - (p - 1) > 1) local_groups.push_back(Group{p - 1, end});
+                        end = p - 1;
+                    }
+                }
+            }
+
+            #pragma omp critical
+            next_groups.insert(next_groups.end(), local_groups.begin(), local_groups.end());
+        }
+        groups = std::move(next_groups);
+
+        // the progress is the number of suffixes whose position in the SA is final
+        size_t unsorted = 0;
+        for(auto const& g : groups) unsorted += g.end - g.start;
+        report_progress(n - unsorted, n);
+
+        // compute the keys for the next round
+        // nb: the suffixes in an unsorted group are longer than h, because shorter suffixes are unique by their keys
+        #pragma omp parallel for schedule(dynamic, 64)
+        for(size_t j = 0; j < groups.size(); j++) {
+            auto const& g = groups[j];
+            for(size_t p = g.start; p < g.end; p++) {
+                auto const i = sa[p];
+                work[p] = Entry{rank[i + h], i};
+            }
+        }
+        h *= 2;
+    }
+}
+
+}
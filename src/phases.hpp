@@ -0,0 +1,132 @@
+/**
+ * MIT License
+ * 
+ * Copyright (c) Patrick Dinklage
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#ifdef BENCHMARK
+#include <cstdio>
+#include <ctime>
+#include <sys/resource.h>
+#endif
+
+namespace repetitiveness {
+
+// records the resources used by the phases of the computation when built with BENCHMARK, and does nothing otherwise
+// for each phase, the wall and CPU time, the bytes read and written (including the SDSL cache) and the peak RSS are
+// reported as key=value pairs
+// nb: the CPU time, I/O and RSS are counted for the whole process, so phases that run concurrently count each other's
+class PhaseLog {
+public:
+#ifdef BENCHMARK
+    // a snapshot of the resources used so far
+    struct Snapshot {
+        std::chrono::steady_clock::time_point wall;
+        double cpu;
+        uint64_t read;
+        uint64_t written;
+    };
+
+    static Snapshot start() {
+        Snapshot s;
+        s.wall = std::chrono::steady_clock::now();
+
+        timespec ts;
+        clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+        s.cpu = ts.tv_sec + 1e-9 * ts.tv_nsec;
+
+        // the characters read and written by system calls, so including page cache hits
+        s.read = 0;
+        s.written = 0;
+        if(auto* f = std::fopen("/proc/self/io", "r")) {
+            char key[32];
+            unsigned long long value;
+            while(std::fscanf(f, "%31s %llu", key, &value) == 2) {
+                if(std::string(key) == "rchar:") s.read = value;
+                else if(std::string(key) == "wchar:") s.written = value;
+            }
+            std::fclose(f);
+        }
+        return s;
+    }
+
+    void stop(std::string const& phase, Snapshot const& s) {
+        auto const end = start();
+
+        rusage usage;
+        getrusage(RUSAGE_SELF, &usage);
+
+        std::lock_guard lock(mutex_);
+        phases_.push_back(Phase {
+            phase,
+            std::chrono::duration<double>(end.wall - s.wall).count(),
+            end.cpu - s.cpu,
+            end.read - s.read,
+            end.written - s.written,
+            uint64_t(usage.ru_maxrss) * 1024,
+        });
+    }
+
+    // passes the key and value of each recorded resource to the given function, in the order the phases were finished
+    template<typename Func>
+    void each(Func&& f) const {
+        std::lock_guard lock(mutex_);
+        for(auto const& p : phases_) {
+            f("time_" + p.name, p.wall);
+            f("cpu_" + p.name, p.cpu);
+            f("read_" + p.name, p.read);
+            f("written_" + p.name, p.written);
+            f("rss_" + p.name, p.peak_rss);
+        }
+    }
+
+private:
+    struct Phase {
+        std::string name;
+        double wall;
+        double cpu;
+        uint64_t read;
+        uint64_t written;
+        uint64_t peak_rss; // at the end of the phase
+    };
+
+    mutable std::mutex mutex_;
+    std::vector<Phase> phases_;
+#else
+    struct Snapshot {};
+
+    static Snapshot start() { return {}; }
+    void stop(std::string const&, Snapshot const&) {}
+    template<typename Func>
+    void each(Func&&) const {}
+#endif
+};
+
+}
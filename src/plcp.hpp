@@ -0,0 +1,104 @@
+/**
+ * MIT License
+ * 
+ * Copyright (c) Patrick Dinklage
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "delta.hpp"
+#include "lce.hpp"
+#include "progress.hpp"
+
+namespace repetitiveness {
+
+// computes the PLCP array in RAM using the PHI algorithm, and fuses other measures into its two passes
+// the pass over the SA that computes PHI also counts the BWT runs like bwt_runs, and every LCP value is added to the
+// histogram for delta as soon as it is known, so the LCP array never needs to be materialized in SA order
+// the BWT runs and the histogram are only computed if given, and the PLCP array is written to the given vector
+// the text must be terminated by a sentinel zero byte, which is told apart from other zero bytes by its position
+template<typename SA, typename Index>
+void construct_plcp_fused(uint8_t const* text, SA const& sa, std::vector<Index>& plcp, size_t* r, LCPHistogram* hist) {
+    static constexpr size_t PREFETCH_DISTANCE = 32;
+
+    auto const n = sa.size();
+
+    // compute PHI in place of PLCP, the sentinel suffix has no predecessor and is marked by n
+    // both the PHI entry and the BWT character of upcoming SA positions are accessed randomly, so they are prefetched
+    plcp.resize(n);
+    size_t changes = 0;
+    uint8_t last = 0;
+    for(size_t i = 0; i < n; i++) {
+        if(i % PROGRESS_INTERVAL == 0) report_progress(i, 2 * n);
+        if(i + PREFETCH_DISTANCE < n) {
+            size_t const k = sa[i + PREFETCH_DISTANCE];
+            __builtin_prefetch(plcp.data() + k, 1);
+            if(r) __builtin_prefetch(text + (k > 0 ? k - 1 : n - 1));
+        }
+
+        size_t const j = sa[i];
+        plcp[j] = i > 0 ? size_t(sa[i-1]) : n;
+        if(r) {
+            // the sentinel always ends a run, but the change following it is not counted
+            auto const c = text[j > 0 ? j - 1 : n - 1];
+            if(i > 0 && sa[i-1] != 0 && (c != last || j == 0)) ++changes;
+            last = c;
+        }
+    }
+    if(r) *r = changes;
+
+    size_t l = 0;
+    for(size_t i = 0; i < n; i++) {
+        if(i % PROGRESS_INTERVAL == 0) report_progress(n + i, 2 * n);
+        size_t const j = plcp[i];
+        if(j == n) {
+            l = 0;
+            plcp[i] = 0;
+        } else {
+            // nb: the sentinel is excluded from the comparison, so it never matches a zero byte
+            l += lce(text, n - 1, i + l, j + l);
+            plcp[i] = l;
+            if(hist) hist->add(l);
+            if(l > 0) --l;
+        }
+    }
+}
+
+// adds the LCP values to the histogram for delta like construct_plcp_fused, but given the PLCP array
+// the sentinel suffix, whose LCP value is not counted, starts at the last text position
+template<typename PLCP>
+void plcp_histogram(PLCP const& plcp, LCPHistogram& hist) {
+    for(size_t i = 0; i + 1 < plcp.size(); i++) hist.add(plcp[i]);
+}
+
+// provides access to the LCP array in SA order given the PLCP array
+template<typename SA, typename PLCP>
+struct PermutedPLCP {
+    SA const& sa;
+    PLCP const& plcp;
+
+    size_t operator[](size_t const i) const { return plcp[sa[i]]; }
+};
+
+}
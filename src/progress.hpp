@@ -0,0 +1,224 @@
+/**
+ * MIT License
+ * 
+ * Copyright (c) Patrick Dinklage
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <omp.h>
+
+namespace repetitiveness {
+
+// thrown by progress updates once the computation has been cancelled
+struct Cancelled : std::exception {
+    char const* what() const noexcept override { return "cancelled"; }
+};
+
+// the progress of a running phase at some point in time
+struct ProgressReport {
+    std::string phase;
+    size_t done;
+    size_t total; // zero if unknown
+    char const* unit; // the unit of done and total, nullptr for bytes or text positions
+    double elapsed; // in seconds
+};
+
+class ProgressPhase;
+
+// keeps track of the running phases and holds the flag for cancelling the computation cooperatively
+// nb: cancelling only sets an atomic flag, so it may be done from a signal handler
+class ProgressMonitor {
+public:
+    void cancel() {
+        cancelled_.store(true, std::memory_order_relaxed);
+    }
+
+    // clears the flag for further computations
+    void reset() {
+        cancelled_.store(false, std::memory_order_relaxed);
+    }
+
+    bool cancelled() const {
+        return cancelled_.load(std::memory_order_relaxed);
+    }
+
+    // the progress of the running phases in the order they were started
+    std::vector<ProgressReport> snapshot() const;
+
+private:
+    friend class ProgressPhase;
+
+    std::atomic<bool> cancelled_ = false;
+    mutable std::mutex mutex_;
+    std::vector<ProgressPhase const*> phases_;
+};
+
+// the monitor of all phases of the process
+inline ProgressMonitor progress_monitor;
+
+// a running phase registered with the monitor for as long as it exists
+// the hot loops of the phase report their progress by storing to atomic counters, which the monitor only reads when
+// asked for a snapshot, so reporting is cheap and needs no locking
+// the phase applies to the thread that creates it, and phases may be nested on the same thread, in which case the
+// innermost one receives the progress
+// nb: the computations for many inputs in parallel, e.g., in block mode, run in OpenMP parallel regions, whose phases
+//     are not registered, because exceptions must not escape the regions and the phases would be too many to report
+class ProgressPhase {
+public:
+    ProgressPhase(std::string name, size_t const total = 0, char const* unit = nullptr)
+        : name_(std::move(name)), total_(total), unit_(unit), start_(std::chrono::steady_clock::now()), outer_(current_) {
+        registered_ = omp_get_level() == 0;
+        if(registered_) {
+            std::lock_guard lock(progress_monitor.mutex_);
+            progress_monitor.phases_.push_back(this);
+            current_ = this;
+        }
+    }
+
+    ~ProgressPhase() {
+        if(registered_) {
+            std::lock_guard lock(progress_monitor.mutex_);
+            std::erase(progress_monitor.phases_, this);
+            current_ = outer_;
+        }
+    }
+
+    ProgressPhase(ProgressPhase const&) = delete;
+    ProgressPhase& operator=(ProgressPhase const&) = delete;
+
+    // stores the progress, which may be done from any thread
+    void update(size_t const done, size_t const total) {
+        done_.store(done, std::memory_order_relaxed);
+        total_.store(total, std::memory_order_relaxed);
+    }
+
+    ProgressReport report() const {
+        return ProgressReport {
+            name_,
+            done_.load(std::memory_order_relaxed),
+            total_.load(std::memory_order_relaxed),
+            unit_,
+            std::chrono::duration<double>(std::chrono::steady_clock::now() - start_).count(),
+        };
+    }
+
+    // the innermost phase of the calling thread, if any
+    static ProgressPhase* current() {
+        return current_;
+    }
+
+private:
+    static inline thread_local ProgressPhase* current_ = nullptr;
+
+    std::string name_;
+    std::atomic<size_t> done_ = 0;
+    std::atomic<size_t> total_;
+    char const* unit_;
+    std::chrono::steady_clock::time_point start_;
+    ProgressPhase* outer_;
+    bool registered_;
+};
+
+inline std::vector<ProgressReport> ProgressMonitor::snapshot() const {
+    std::lock_guard lock(mutex_);
+    std::vector<ProgressReport> reports;
+    for(auto const* p : phases_) reports.push_back(p->report());
+    return reports;
+}
+
+// the number of iterations after which the hot loops report their progress
+constexpr size_t PROGRESS_INTERVAL = size_t(1) << 16;
+
+// throws Cancelled if the computation was cancelled
+inline void check_cancelled() {
+    if(progress_monitor.cancelled()) throw Cancelled();
+}
+
+// reports the progress of the calling thread's phase, if any, and then throws Cancelled if the computation was cancelled
+// without a phase or within an OpenMP parallel region, nothing is reported and the computation cannot be cancelled
+inline void report_progress(size_t const done, size_t const total) {
+    if(auto* p = ProgressPhase::current(); p && omp_get_level() == 0) {
+        p->update(done, total);
+        check_cancelled();
+    }
+}
+
+// periodically passes a snapshot of the running phases to the given function from a thread of its own, if any, and
+// cancels the computation once the time limit has passed, if any
+class ProgressReporter {
+public:
+    using Callback = std::function<void(std::vector<ProgressReport> const&)>;
+
+    ProgressReporter(std::chrono::milliseconds const interval, Callback callback, std::chrono::milliseconds const time_limit = {})
+        : interval_(interval), callback_(std::move(callback)) {
+        auto const deadline = std::chrono::steady_clock::now() + time_limit;
+        thread_ = std::thread([this, deadline, time_limit](){
+            std::unique_lock lock(mutex_);
+            while(!stop_) {
+                auto wake = std::chrono::steady_clock::now() + interval_;
+                if(time_limit.count() > 0) wake = std::min(wake, deadline);
+                cv_.wait_until(lock, wake, [&](){ return stop_; });
+                if(stop_) break;
+
+                if(time_limit.count() > 0 && std::chrono::steady_clock::now() >= deadline && !progress_monitor.cancelled()) {
+                    progress_monitor.cancel();
+                }
+                if(callback_) callback_(progress_monitor.snapshot());
+            }
+        });
+    }
+
+    ~ProgressReporter() {
+        {
+            std::lock_guard lock(mutex_);
+            stop_ = true;
+        }
+        cv_.notify_one();
+        thread_.join();
+    }
+
+    ProgressReporter(ProgressReporter const&) = delete;
+    ProgressReporter& operator=(ProgressReporter const&) = delete;
+
+private:
+    std::chrono::milliseconds interval_;
+    Callback callback_;
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    bool stop_ = false;
+    std::thread thread_;
+};
+
+}
@@ -0,0 +1,346 @@
+/**
+ * MIT License
+ * 
+ * Copyright (c) Patrick Dinklage
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <span>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "bwt.hpp"
+#include "delta.hpp"
+#include "entropy.hpp"
+#include "lz77.hpp"
+#include "lz78.hpp"
+#include "plcp.hpp"
+#include "progress.hpp"
+#include "sa.hpp"
+#include "uint40.hpp"
+
+// the library interface for computing the measures of a text held in RAM, which the command line tool builds upon
+namespace repetitiveness {
+
+// the data structures that measures may require
+enum Structure : unsigned {
+    STRUCT_SA  = 1 << 0,
+    STRUCT_LCP = 1 << 1,
+};
+
+// the measures that can be computed
+enum Measure : unsigned {
+    MEASURE_N     = 1 << 0,
+    MEASURE_SIGMA = 1 << 1,
+    MEASURE_H0    = 1 << 2,
+    MEASURE_R     = 1 << 3,
+    MEASURE_Z78   = 1 << 4,
+    MEASURE_Z77   = 1 << 5,
+    MEASURE_DELTA = 1 << 6,
+    MEASURE_HK    = 1 << 7,
+};
+
+// the measures computed unless requested otherwise
+inline constexpr unsigned DEFAULT_MEASURES = ~0U & ~MEASURE_HK;
+
+struct MeasureInfo {
+    Measure measure;
+    char const* name;
+    unsigned structures; // the data structures required to compute the measure
+};
+
+// all measures in order of output
+inline constexpr MeasureInfo MEASURES[] = {
+    { MEASURE_N,     "n",     0 },
+    { MEASURE_SIGMA, "sigma", 0 },
+    { MEASURE_H0,    "h0",    0 },
+    { MEASURE_HK,    "hk",    STRUCT_SA | STRUCT_LCP }, // nb: one value for each of the given orders
+    { MEASURE_R,     "r",     STRUCT_SA },
+    { MEASURE_Z78,   "z78",   0 },
+    { MEASURE_Z77,   "z77",   STRUCT_SA }, // nb: plus the LCP array unless z77 is computed by comparing characters
+    { MEASURE_DELTA, "delta", STRUCT_SA | STRUCT_LCP },
+};
+
+// the options for computing the measures in RAM
+struct MeasureOptions {
+    unsigned measures = DEFAULT_MEASURES;
+    std::vector<size_t> hk_orders = { 1, 2, 3, 4 }; // the orders k for which H_k is computed
+    SABackend sa_backend = SABackend::DIVSUFSORT;
+    std::string trie = "list"; // the LZ78 trie implementation: list, hash or hybrid
+    bool z77_lcp = true; // obtain the LZ77 factor lengths from the LCP array rather than by comparing characters
+};
+
+// determines the data structures required to compute the given measures, resolving their dependencies
+inline unsigned required_structures(unsigned const measures, bool const z77_lcp) {
+    unsigned structures = 0;
+    for(auto const& m : MEASURES) {
+        if(measures & m.measure) structures |= m.structures;
+    }
+    if(z77_lcp && (measures & MEASURE_Z77)) structures |= STRUCT_LCP;
+
+    // the LCP array is computed from the SA
+    if(structures & STRUCT_LCP) structures |= STRUCT_SA;
+    return structures;
+}
+
+// a trie of each implementation, which is created on first use and cleared for reuse afterwards
+struct TrieCache {
+    std::unique_ptr<ListTrie> list;
+    std::unique_ptr<HashTrie> hash;
+    std::unique_ptr<HybridTrie> hybrid;
+
+    template<typename Trie>
+    static Trie& reuse(std::unique_ptr<Trie>& trie) {
+        if(trie) {
+            trie->clear();
+        } else {
+            trie = std::make_unique<Trie>();
+        }
+        return *trie;
+    }
+};
+
+// counts the LZ78 factors of each of the given prefixes of the text using the trie implementation of the given name
+// the phrases are passed on to the given receiver like by lz78_prefixes
+template<typename PhraseFunc = IgnorePhrases>
+std::vector<size_t> lz78_by_trie(std::string const& trie, TrieCache& tries, uint8_t const* text, std::vector<size_t> const& prefixes, size_t& trie_memory,
+                                 PhraseFunc&& on_phrase = {}, size_t* final_phrase = nullptr) {
+    if(trie == "hash") return lz78_prefixes(TrieCache::reuse(tries.hash), text, prefixes, trie_memory, on_phrase, final_phrase);
+    if(trie == "hybrid") return lz78_prefixes(TrieCache::reuse(tries.hybrid), text, prefixes, trie_memory, on_phrase, final_phrase);
+    return lz78_prefixes(TrieCache::reuse(tries.list), text, prefixes, trie_memory, on_phrase, final_phrase);
+}
+
+// the higher-order empirical entropies of a text, each paired with its order
+using HkResult = std::vector<std::pair<size_t, double>>;
+
+// computes the higher-order empirical entropy of the text for each of the given orders from the SA and LCP array
+template<typename SA, typename LCP>
+HkResult hk_by_order(std::vector<size_t> const& orders, uint8_t const* text, SA& sa, LCP& lcp) {
+    auto const hk = higher_order_entropy(text, sa, lcp, orders);
+    HkResult result;
+    for(size_t x = 0; x < orders.size(); x++) result.emplace_back(orders[x], hk[x]);
+    return result;
+}
+
+// the measures computed for a text
+struct Result {
+    size_t n = 0;
+    size_t sigma = 0;
+    double h0 = 0;
+    size_t r = 0;
+    size_t z78 = 0;
+    size_t z77 = 0;
+    double delta = 0;
+    HkResult hk;
+};
+
+// the data structures held in RAM while computing the measures for a text
+// they may be reused for further texts, e.g., for many files in a row, in which case vectors keep their capacity
+template<typename Index>
+struct Workspace {
+    std::vector<Index> sa;
+    std::vector<Index> plcp;
+    LCPHistogram hist;
+    TrieCache tries;
+};
+
+// computes r, delta and H_k for the text from its SA in the workspace, which is then followed by the PLCP array if the
+// LCP information is needed
+template<typename Index>
+void compute_by_sa(MeasureOptions const& opts, uint8_t const* text_data, Workspace<Index>& ws, Result& result, bool const need_lcp) {
+    auto const measures = opts.measures;
+    auto& sa = ws.sa;
+    if(need_lcp) {
+        {
+            ProgressPhase phase("lcp", 2 * sa.size());
+            ws.hist.clear();
+            construct_plcp_fused(text_data, sa, ws.plcp, (measures & MEASURE_R) ? &result.r : nullptr, &ws.hist);
+            result.delta = ws.hist.substring_complexity(sa.size());
+        }
+        if(measures & MEASURE_HK) {
+            ProgressPhase phase("hk", sa.size());
+            PermutedPLCP lcp { sa, ws.plcp };
+            result.hk = hk_by_order(opts.hk_orders, text_data, sa, lcp);
+        }
+    } else if(measures & MEASURE_R) {
+        ProgressPhase phase("r", sa.size());
+        size_t sentinel_pos;
+        auto const bwt = construct_bwt(text_data, sa, sentinel_pos);
+        result.r = bwt_runs((uint8_t const*)bwt.data(), sa.size(), sentinel_pos);
+    }
+}
+
+// computes the measures that are obtained for all of the given prefixes of the text from a single pass over the text or
+// the SA of the whole text, i.e., the alphabet, H0, z78 and z77, as well as r, delta and H_k of the whole text
+// the results for the prefixes are stored in the given results, which are in the same order
+// the text of length n must be terminated by the sentinel, and the data structures are held in the given workspace
+template<typename Index>
+void compute_single_pass(MeasureOptions const& opts, uint8_t const* text_data, size_t const n, std::vector<size_t> const& prefixes, Workspace<Index>& ws, size_t& trie_memory, bool const verbose, std::vector<Result>& results) {
+    auto const measures = opts.measures;
+    auto const z77_lcp = opts.z77_lcp;
+
+    auto const structures = required_structures(measures, z77_lcp);
+    size_t const num_prefixes = prefixes.size();
+
+    if(measures & (MEASURE_SIGMA | MEASURE_H0)) {
+        auto const h0s = alphabet_entropy_prefixes(text_data, prefixes);
+        for(size_t x = 0; x < num_prefixes; x++) std::tie(results[x].sigma, results[x].h0) = h0s[x];
+    }
+
+    trie_memory = 0;
+    if(measures & MEASURE_Z78) {
+        ProgressPhase phase("z78", n - 1);
+        auto const z78s = lz78_by_trie(opts.trie, ws.tries, text_data, prefixes, trie_memory);
+        for(size_t x = 0; x < num_prefixes; x++) results[x].z78 = z78s[x];
+    }
+
+    if(structures & STRUCT_SA) {
+        if(verbose) {
+            std::cerr << "computing SA ...";
+            std::cerr.flush();
+        }
+        {
+            ProgressPhase phase("sa");
+            construct_sa_in_memory(text_data, n, opts.sa_backend, ws.sa);
+        }
+        if(verbose) std::cerr << std::endl;
+
+        compute_by_sa(opts, text_data, ws, results[num_prefixes - 1], structures & STRUCT_LCP);
+
+        if(measures & MEASURE_Z77) {
+            ProgressPhase phase("z77", 2 * n);
+            std::vector<size_t> z77s;
+            if(z77_lcp) {
+                PermutedPLCP lcp { ws.sa, ws.plcp };
+                z77s = lz77_lcp<Index>(ws.sa, lcp, prefixes);
+            } else {
+                z77s = lz77_psv<Index>(text_data, ws.sa, prefixes);
+            }
+            for(size_t x = 0; x < num_prefixes; x++) results[x].z77 = z77s[x];
+        }
+    }
+}
+
+// computes the requested measures for each of the given prefixes of the loaded text in RAM
+// the prefix lengths must be ascending, and the last must be the whole text without the sentinel
+// the alphabet, H0, z78 and z77 are obtained for all prefixes from a single pass over the text or the SA of the whole text,
+// but r, delta and H_k require the SA of each prefix, which is constructed from scratch for all but the last
+// the text of length n must be terminated by the sentinel, and the data structures are held in the given workspace
+// nb: each shorter prefix is terminated by the sentinel temporarily while constructing its SA, so the text must be writable,
+// but it is restored afterwards
+// the progress is printed only if verbose, but it is always reported to the progress monitor, and if the computation is
+// cancelled, Cancelled is thrown
+template<typename Index>
+std::vector<Result> compute_prefixes(MeasureOptions const& opts, uint8_t* text_data, size_t const n, std::vector<size_t> const& prefixes, Workspace<Index>& ws, size_t& trie_memory, bool const verbose) {
+    auto const measures = opts.measures;
+    size_t const num_prefixes = prefixes.size();
+
+    std::vector<Result> results(num_prefixes);
+    for(size_t x = 0; x < num_prefixes; x++) results[x].n = prefixes[x];
+
+    if(measures & (MEASURE_R | MEASURE_DELTA | MEASURE_HK)) {
+        for(size_t x = 0; x + 1 < num_prefixes; x++) {
+            if(verbose) {
+                std::cerr << "computing SA of prefix of length " << prefixes[x] << " ...";
+                std::cerr.flush();
+            }
+
+            // temporarily terminate the prefix by the sentinel
+            auto const m = prefixes[x];
+            auto const c = text_data[m];
+            text_data[m] = 0;
+            try {
+                {
+                    ProgressPhase phase("sa");
+                    construct_sa_in_memory(text_data, m + 1, opts.sa_backend, ws.sa);
+                }
+                compute_by_sa(opts, text_data, ws, results[x], measures & (MEASURE_DELTA | MEASURE_HK));
+            } catch(Cancelled const&) {
+                text_data[m] = c;
+                throw;
+            }
+            text_data[m] = c;
+
+            if(verbose) std::cerr << std::endl;
+        }
+    }
+
+    compute_single_pass(opts, (uint8_t const*)text_data, n, prefixes, ws, trie_memory, verbose, results);
+    return results;
+}
+
+// how the text passed to compute is terminated
+enum class Termination {
+    SENTINEL, // the last byte is the sentinel, a zero byte that is not part of the text, and the text is used in place
+    NONE,     // all bytes are part of the text, and a copy terminated by the sentinel is made
+};
+
+// computes the requested measures for the given text in RAM and stores them in the given result
+// zero bytes are regular characters except for the sentinel, whose presence must be given by the termination
+// the data structures are held in the given workspace, which may be reused for further texts of up to 2^32 - 1 bytes
+// the text is never written to, and the computation may be cancelled via the progress monitor
+// returns nullptr on success, and otherwise a description of the error
+inline char const* compute(std::span<uint8_t const> const text, Termination const termination, MeasureOptions const& opts, Result& result, Workspace<uint32_t>& ws) {
+    if(termination == Termination::SENTINEL && (text.empty() || text.back() != 0)) return "the text is not terminated by the sentinel";
+
+    std::vector<uint8_t> copy;
+    uint8_t const* data = text.data();
+    size_t n = text.size();
+    if(termination == Termination::NONE) {
+        copy.reserve(n + 1);
+        copy.assign(text.begin(), text.end());
+        copy.push_back(0);
+        data = copy.data();
+        ++n;
+    }
+    if(n == 1) return "the input is empty";
+
+    std::vector<Result> results(1);
+    results[0].n = n - 1;
+    size_t trie_memory;
+    try {
+        if(n <= UINT32_MAX) {
+            compute_single_pass<uint32_t>(opts, data, n, { n - 1 }, ws, trie_memory, false, results);
+        } else if(n <= uint40_t::MAX) {
+            Workspace<uint40_t> large_ws;
+            compute_single_pass<uint40_t>(opts, data, n, { n - 1 }, large_ws, trie_memory, false, results);
+        } else {
+            return "the input is too large";
+        }
+    } catch(Cancelled const&) {
+        return "the computation was cancelled";
+    }
+    result = std::move(results[0]);
+    return nullptr;
+}
+
+// computes the requested measures for the given text in RAM using a workspace of its own
+inline char const* compute(std::span<uint8_t const> const text, Termination const termination, MeasureOptions const& opts, Result& result) {
+    Workspace<uint32_t> ws;
+    return compute(text, termination, opts, result, ws);
+}
+
+}
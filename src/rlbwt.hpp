@@ -0,0 +1,96 @@
+/**
+ * MIT License
+ * 
+ * Copyright (c) Patrick Dinklage
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#pragma once
+
+#include <cstdint>
+
+#include "bwt.hpp"
+#include "writer.hpp"
+
+namespace repetitiveness {
+
+// writes the run-length encoded BWT, along with the SA samples at the run boundaries that an r-index needs, and counts
+// the BWT runs like bwt_runs on the way
+// the SA is accessed sequentially like for bwt_runs_streamed, so it may also be streamed from disk
+//
+// the file starts with the eight bytes "RLBWT001" and the BWT length n (including the sentinel) as a 64-bit word,
+// followed by one record per run: the character, the run length as a varint, and the SA values at the first and (for
+// runs longer than one) the last position of the run as varints
+// the sentinel forms a run of its own, whose character is zero, and the file ends with the number of runs and the number
+// of the sentinel's run as 64-bit words
+// all words are little-endian
+template<typename SA>
+size_t write_rlbwt(uint8_t const* text, SA& sa, BinaryWriter& out) {
+    size_t const n = sa.size();
+
+    static constexpr char MAGIC[] = "RLBWT001";
+    for(size_t k = 0; k < 8; k++) out.put(uint8_t(MAGIC[k]));
+    out.put_u64(n);
+
+    // the current run
+    uint8_t head = 0;
+    size_t length = 0;
+    size_t first = 0;
+    size_t last = 0;
+    bool sentinel = false;
+
+    auto flush = [&](){
+        out.put(head);
+        out.put_varint(length);
+        out.put_varint(first);
+        if(length > 1) out.put_varint(last);
+    };
+
+    size_t runs = 0;
+    size_t sentinel_run = 0;
+    bwt_blocks(text, sa, [&](uint8_t const* block, size_t const* sa_block, size_t const m){
+        for(size_t k = 0; k < m; k++) {
+            auto const c = block[k];
+            auto const j = sa_block[k];
+            if(length > 0 && !sentinel && j != 0 && c == head) {
+                ++length;
+                last = j;
+            } else {
+                if(length > 0) flush();
+                if(j == 0) sentinel_run = runs;
+                ++runs;
+                head = c;
+                length = 1;
+                first = last = j;
+                sentinel = (j == 0);
+            }
+        }
+    });
+    flush();
+
+    out.put_u64(runs);
+    out.put_u64(sentinel_run);
+
+    // the sentinel's run is not counted, and neither is the change following it
+    return runs - 1 - (sentinel_run + 1 < runs ? 1 : 0);
+}
+
+}
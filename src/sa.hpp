@@ -0,0 +1,72 @@
+/**
+ * MIT License
+ * 
+ * Copyright (c) Patrick Dinklage
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <type_traits>
+#include <vector>
+
+#include <divsufsort.h>
+#include <divsufsort64.h>
+
+#include "parallel_sa.hpp"
+
+namespace repetitiveness {
+
+// the available backends for constructing the suffix array in RAM
+enum class SABackend {
+    DIVSUFSORT, // divsufsort (sequential)
+    PARALLEL,   // parallel prefix doubling
+};
+
+// constructs the suffix array of the text in RAM using the given backend
+// the given vector is resized to fit, so its memory may be reused
+template<typename Index>
+void construct_sa_in_memory(uint8_t const* text, size_t const n, SABackend const backend, std::vector<Index>& sa) {
+    sa.resize(n);
+    switch(backend) {
+        case SABackend::DIVSUFSORT:
+            if constexpr(std::is_same_v<Index, uint32_t>) {
+                if(n < (size_t(1) << 31)) {
+                    divsufsort(text, (saidx_t*)sa.data(), n);
+                    break;
+                }
+            }
+
+            // divsufsort64 needs 64-bit entries, so the result needs to be narrowed
+            {
+                std::vector<saidx64_t> sa64(n);
+                divsufsort64(text, sa64.data(), n);
+                for(size_t i = 0; i < n; i++) sa[i] = sa64[i];
+            }
+            break;
+
+        case SABackend::PARALLEL:
+            construct_sa_parallel(text, n, sa.data());
+            break;
+    }
+}
+
+}
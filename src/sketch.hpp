@@ -0,0 +1,161 @@
+/**
+ * MIT License
+ * 
+ * Copyright (c) Patrick Dinklage
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+namespace repetitiveness {
+
+// estimates the number of distinct elements given by their 64-bit hashes using 2^p one-byte registers (HyperLogLog)
+// the relative standard error is about 1.04 / sqrt(2^p)
+class HyperLogLog {
+private:
+    size_t p_;
+    std::vector<uint8_t> registers_;
+
+public:
+    explicit HyperLogLog(size_t const p = 14) : p_(p), registers_(size_t(1) << p, 0) {
+    }
+
+    void add(uint64_t const hash) {
+        auto const i = hash >> (64 - p_);
+        auto const rest = hash << p_;
+        uint8_t const rank = rest ? uint8_t(__builtin_clzll(rest) + 1) : uint8_t(64 - p_ + 1);
+        registers_[i] = std::max(registers_[i], rank);
+    }
+
+    // adds the elements of another sketch with the same number of registers
+    void merge(HyperLogLog const& other) {
+        for(size_t i = 0; i < registers_.size(); i++) registers_[i] = std::max(registers_[i], other.registers_[i]);
+    }
+
+    double estimate() const {
+        double const m = double(registers_.size());
+        double sum = 0;
+        size_t zeros = 0;
+        for(auto const r : registers_) {
+            sum += std::ldexp(1.0, -int(r));
+            if(r == 0) ++zeros;
+        }
+
+        double const alpha = 0.7213 / (1.0 + 1.079 / m);
+        double const raw = alpha * m * m / sum;
+
+        // small cardinalities are estimated by linear counting
+        if(raw <= 2.5 * m && zeros > 0) return m * std::log(m / double(zeros));
+        return raw;
+    }
+
+    double relative_error() const {
+        return 1.04 / std::sqrt(double(registers_.size()));
+    }
+};
+
+// sketches the number of distinct substrings of each of the given lengths k of a text, from which the substring
+// complexity delta is estimated as the maximum over all k of the number of distinct substrings of length k divided by k
+// the substrings are hashed by a rolling polynomial hash modulo the Mersenne prime 2^61 - 1, which is robust against
+// the highly structured inputs that break hashing modulo 2^64, like the Thue-Morse word
+// nb: since delta is the maximum over all lengths, the estimate is obtained for the given lengths only
+class KmerSketch {
+private:
+    static constexpr uint64_t P = (uint64_t(1) << 61) - 1;
+    static constexpr uint64_t BASE = 0x1F2E3D4C5B6A79ULL % P;
+
+    std::vector<size_t> ks_;
+    std::vector<uint64_t> base_pow_; // BASE^(k-1) for each k
+    std::vector<HyperLogLog> hll_;
+
+    static uint64_t mul(uint64_t const a, uint64_t const b) {
+        auto const x = __uint128_t(a) * b;
+        auto const r = (uint64_t(x) & P) + uint64_t(x >> 61);
+        return r >= P ? r - P : r;
+    }
+
+    static uint64_t mix(uint64_t h) {
+        h ^= h >> 33;
+        h *= 0xFF51AFD7ED558CCDULL;
+        h ^= h >> 33;
+        h *= 0xC4CEB9FE1A85EC53ULL;
+        h ^= h >> 33;
+        return h;
+    }
+
+public:
+    explicit KmerSketch(std::vector<size_t> const& ks) : ks_(ks), hll_(ks.size()) {
+        for(auto const k : ks_) {
+            uint64_t pow = 1;
+            for(size_t j = 1; j < k; j++) pow = mul(pow, BASE);
+            base_pow_.push_back(pow);
+        }
+    }
+
+    // the largest length, the history needed to continue the sketch in the next part of the text is one less
+    size_t max_k() const { return ks_.empty() ? 0 : *std::max_element(ks_.begin(), ks_.end()); }
+
+    // adds the substrings ending in s[history..m), where the first history characters of s precede them in the text
+    // they are either the beginning of the text or at least max_k - 1 characters
+    void add(uint8_t const* s, size_t const m, size_t const history) {
+        for(size_t x = 0; x < ks_.size(); x++) {
+            size_t const k = ks_[x];
+            size_t const first = history >= k - 1 ? history - (k - 1) : 0;
+            if(m < first + k) continue;
+
+            auto& hll = hll_[x];
+            auto const pow = base_pow_[x];
+            uint64_t h = 0;
+            for(size_t i = first; i + 1 < first + k; i++) {
+                h = mul(h, BASE) + s[i] + 1;
+                if(h >= P) h -= P;
+            }
+            for(size_t e = first + k - 1; e < m; e++) {
+                h = mul(h, BASE) + s[e] + 1;
+                if(h >= P) h -= P;
+                hll.add(mix(h));
+
+                // remove the first character of the window
+                auto const out = mul(s[e + 1 - k] + 1, pow);
+                h = h >= out ? h - out : h + P - out;
+            }
+        }
+    }
+
+    void merge(KmerSketch const& other) {
+        for(size_t x = 0; x < ks_.size(); x++) hll_[x].merge(other.hll_[x]);
+    }
+
+    // estimates delta and reports the relative standard error of the underlying estimates
+    double delta(double& relative_error) const {
+        double delta = 0;
+        for(size_t x = 0; x < ks_.size(); x++) delta = std::max(delta, hll_[x].estimate() / double(ks_[x]));
+        relative_error = hll_.empty() ? 0 : hll_[0].relative_error();
+        return delta;
+    }
+};
+
+}
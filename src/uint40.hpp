@@ -0,0 +1,49 @@
+/**
+ * MIT License
+ * 
+ * Copyright (c) Patrick Dinklage
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#pragma once
+
+#include <cstdint>
+
+namespace repetitiveness {
+
+// unsigned 40-bit integer stored in five bytes
+class uint40_t {
+private:
+    uint32_t lo_;
+    uint8_t hi_;
+
+public:
+    static constexpr uint64_t MAX = (uint64_t(1) << 40) - 1;
+
+    uint40_t() = default;
+    uint40_t(uint64_t const x) : lo_(uint32_t(x)), hi_(uint8_t(x >> 32)) {}
+
+    operator uint64_t() const { return (uint64_t(hi_) << 32) | lo_; }
+} __attribute__((packed));
+
+static_assert(sizeof(uint40_t) == 5);
+
+}
@@ -0,0 +1,155 @@
+/**
+ * MIT License
+ * 
+ * Copyright (c) Patrick Dinklage
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace repetitiveness {
+
+// writes binary data to a file through two buffers: while one is being filled, the other is written by a background
+// thread, so the producer only waits if it fills a buffer faster than the file can take the previous one
+// integers are written either as fixed-width little-endian words or as varints, i.e., seven bits per byte starting with
+// the least significant ones, and the highest bit of each byte is set if more bytes follow
+class BinaryWriter {
+private:
+    static constexpr size_t BUFFER_SIZE = size_t(1) << 20;
+
+    int fd_ = -1;
+    bool ok_ = false;
+
+    // the buffer being filled
+    std::vector<uint8_t> buffer_;
+    size_t size_ = 0;
+
+    // the buffer handed to the background thread, which is empty when the thread is idle
+    std::vector<uint8_t> pending_;
+    size_t pending_size_ = 0;
+    bool done_ = false;
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::thread thread_;
+
+    void write_pending() {
+        std::unique_lock lock(mutex_);
+        while(true) {
+            cv_.wait(lock, [&](){ return pending_size_ > 0 || done_; });
+            if(pending_size_ == 0) return;
+
+            // write without holding the lock, the producer does not touch the pending buffer until it is empty
+            auto const m = pending_size_;
+            lock.unlock();
+            bool ok = true;
+            for(size_t num_written = 0; ok && num_written < m;) {
+                auto const w = ::write(fd_, pending_.data() + num_written, m - num_written);
+                if(w <= 0) ok = false; else num_written += w;
+            }
+            lock.lock();
+
+            if(!ok) ok_ = false;
+            pending_size_ = 0;
+            cv_.notify_all();
+        }
+    }
+
+    // hands the filled buffer to the background thread once it is idle, or discards it if the file could not be opened
+    void hand_off() {
+        if(fd_ < 0) {
+            size_ = 0;
+            return;
+        }
+
+        std::unique_lock lock(mutex_);
+        cv_.wait(lock, [&](){ return pending_size_ == 0; });
+        std::swap(buffer_, pending_);
+        pending_size_ = size_;
+        size_ = 0;
+        cv_.notify_all();
+    }
+
+public:
+    explicit BinaryWriter(std::string const& path) : buffer_(BUFFER_SIZE), pending_(BUFFER_SIZE) {
+        fd_ = open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        ok_ = (fd_ >= 0);
+        if(ok_) thread_ = std::thread([this](){ write_pending(); });
+    }
+
+    BinaryWriter(BinaryWriter const&) = delete;
+    BinaryWriter& operator=(BinaryWriter const&) = delete;
+
+    ~BinaryWriter() {
+        close();
+    }
+
+    // reports whether the file was opened and all data written so far could be written
+    bool good() {
+        std::lock_guard lock(mutex_);
+        return ok_;
+    }
+
+    void put(uint8_t const x) {
+        if(size_ == BUFFER_SIZE) hand_off();
+        buffer_[size_++] = x;
+    }
+
+    void put_u64(uint64_t const x) {
+        for(size_t k = 0; k < 8; k++) put(uint8_t(x >> (8 * k)));
+    }
+
+    void put_varint(uint64_t x) {
+        while(x >= 0x80) {
+            put(uint8_t(x) | 0x80);
+            x >>= 7;
+        }
+        put(uint8_t(x));
+    }
+
+    // writes the remaining buffered data and closes the file, and reports whether all data could be written
+    bool close() {
+        if(fd_ >= 0) {
+            if(size_ > 0) hand_off();
+            {
+                std::lock_guard lock(mutex_);
+                done_ = true;
+                cv_.notify_all();
+            }
+            thread_.join();
+            if(::close(fd_) != 0) ok_ = false;
+            fd_ = -1;
+        }
+        return ok_;
+    }
+};
+
+}